@@ -0,0 +1,336 @@
+#ifndef ASYNC_SORT_H
+#define ASYNC_SORT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "QuickSort.h"
+#include "ThreadPool.h"
+
+// Части не длиннее этого порога сортируются sort() целиком: отмена и срок
+// проверяются между разбиениями, так что задержка реакции на них не больше
+// времени сортировки одной такой части
+constexpr std::ptrdiff_t ASYNC_SORT_GRAIN = 1 << 15;
+
+enum class SortStatus
+{
+    running,
+    completed,
+    cancelled,
+    deadline_expired,
+    // Компаратор или перемещение бросили исключение; get() его пробрасывает
+    failed
+};
+
+// Общее состояние сортировки: задачи пула держат его через shared_ptr,
+// поэтому оно переживает и SortHandle, и последнюю задачу
+class AsyncSortState final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    AsyncSortState(std::size_t size, Clock::time_point deadline) : size_(size), deadline_(deadline) {}
+
+    // Проверка на границе разбиения: отменена ли сортировка или истёк срок
+    bool stopping()
+    {
+        if (stop_.load(std::memory_order_relaxed))
+            return true;
+        if (deadline_ != Clock::time_point::max() && Clock::now() >= deadline_)
+        {
+            deadline_expired_ = true;
+            stop_ = true;
+            return true;
+        }
+        return false;
+    }
+
+    void request_stop()
+    {
+        stop_ = true;
+    }
+
+    void add_finalized(std::size_t count)
+    {
+        finalized_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    std::size_t finalized() const
+    {
+        return finalized_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    void add_task()
+    {
+        ++pending_;
+    }
+
+    void fail(std::exception_ptr error)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_)
+                error_ = error;
+        }
+        stop_ = true;
+    }
+
+    // Последняя завершившаяся задача подводит итог и будит ожидающих
+    void task_done()
+    {
+        if (--pending_ > 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error_)
+            status_ = SortStatus::failed;
+        else if (finalized() == size_)
+            status_ = SortStatus::completed;
+        else if (deadline_expired_)
+            status_ = SortStatus::deadline_expired;
+        else
+            status_ = SortStatus::cancelled;
+        done_.notify_all();
+    }
+
+    SortStatus status()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return status_;
+    }
+
+    SortStatus wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]
+                   { return status_ != SortStatus::running; });
+        return status_;
+    }
+
+    template <typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period> &timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return done_.wait_for(lock, timeout, [this]
+                              { return status_ != SortStatus::running; });
+    }
+
+    std::exception_ptr error()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_;
+    }
+
+private:
+    const std::size_t size_;
+    const Clock::time_point deadline_;
+
+    std::atomic<std::ptrdiff_t> pending_{1};
+    std::atomic<std::size_t> finalized_{0};
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> deadline_expired_{false};
+
+    std::mutex mutex_;
+    std::condition_variable done_;
+    SortStatus status_ = SortStatus::running;
+    std::exception_ptr error_;
+};
+
+// Дескриптор запущенной sort_async(). Диапазон и компаратор должны
+// жить, пока сортировка не завершится; пул может быть разрушен раньше
+// дескриптора (см. sort_async()). Деструктор отменяет незавершённую
+// сортировку и ждёт её задач, поэтому после него диапазон никто не трогает;
+// ожидание не дольше сортировки одной части из ASYNC_SORT_GRAIN элементов
+class SortHandle final
+{
+    std::shared_ptr<AsyncSortState> state_;
+
+public:
+    explicit SortHandle(std::shared_ptr<AsyncSortState> state) : state_(std::move(state)) {}
+
+    SortHandle(SortHandle &&) = default;
+    SortHandle &operator=(SortHandle &&other)
+    {
+        if (this != &other)
+        {
+            release();
+            state_ = std::move(other.state_);
+        }
+        return *this;
+    }
+
+    SortHandle(const SortHandle &) = delete;
+    SortHandle &operator=(const SortHandle &) = delete;
+
+    ~SortHandle()
+    {
+        release();
+    }
+
+    // Кооперативная отмена: задачи останавливаются на ближайшей границе
+    // разбиения. Диапазон остаётся перестановкой входа, а уже учтённые
+    // progress() элементы стоят на своих итоговых местах
+    void cancel()
+    {
+        state_->request_stop();
+    }
+
+    // Число элементов, занявших итоговые места
+    std::size_t progress() const
+    {
+        return state_->finalized();
+    }
+
+    std::size_t size() const
+    {
+        return state_->size();
+    }
+
+    bool ready() const
+    {
+        return state_->status() != SortStatus::running;
+    }
+
+    SortStatus status() const
+    {
+        return state_->status();
+    }
+
+    SortStatus wait() const
+    {
+        return state_->wait();
+    }
+
+    // true, если сортировка завершилась за timeout
+    template <typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period> &timeout) const
+    {
+        return state_->wait_for(timeout);
+    }
+
+    // Ждёт завершения; если сортировка упала, пробрасывает её исключение
+    SortStatus get() const
+    {
+        SortStatus status = state_->wait();
+        if (status == SortStatus::failed)
+            std::rethrow_exception(state_->error());
+        return status;
+    }
+
+private:
+    void release()
+    {
+        if (!state_)
+            return;
+        state_->request_stop();
+        state_->wait();
+        state_.reset();
+    }
+};
+
+// Задача асинхронной сортировки устроена как parallel_quicksort_task(), но
+// перед каждым разбиением проверяет отмену и срок, а отсортированные
+// элементы учитывает в прогрессе: опорные после разбиения и части после sort()
+template <typename T, typename Compare>
+void async_sort_task(T *first, T *last, Compare comp, int depth_limit, bool leftmost, ThreadPool &pool,
+                     std::shared_ptr<AsyncSortState> state)
+{
+    try
+    {
+        while (last - first > ASYNC_SORT_GRAIN && !state->stopping())
+        {
+            if (depth_limit == 0)
+            {
+                heap_sort(first, last, comp);
+                state->add_finalized(static_cast<std::size_t>(last - first));
+                first = last;
+                break;
+            }
+            --depth_limit;
+
+            T *middle = first + (last - first) / 2;
+            T *pivot = choose_pivot<SortTraits<T, Compare>>(first, last, comp);
+
+            T *lo, *hi;
+            if (many_duplicates(first, middle, last, pivot, comp, leftmost))
+            {
+                std::pair<T *, T *> equal = partition_three_way(first, last, pivot, comp);
+                lo = equal.first;
+                hi = equal.second;
+            }
+            else
+            {
+                lo = partition_with<SortTraits<T, Compare>>(first, last, pivot, comp).first;
+                hi = lo + 1;
+            }
+            state->add_finalized(static_cast<std::size_t>(hi - lo));
+
+            // Задача учитывается до постановки, иначе она могла бы
+            // завершиться раньше учёта; если submit() бросил, учёт отменяется
+            state->add_task();
+            try
+            {
+                pool.submit([=, &pool]
+                            { async_sort_task(hi, last, comp, depth_limit, false, pool, state); });
+            }
+            catch (...)
+            {
+                state->task_done();
+                throw;
+            }
+            last = lo;
+        }
+
+        if (last - first <= ASYNC_SORT_GRAIN && !state->stopping())
+        {
+            sort(first, last, comp);
+            state->add_finalized(static_cast<std::size_t>(last - first));
+        }
+    }
+    catch (...)
+    {
+        state->fail(std::current_exception());
+    }
+
+    state->task_done();
+}
+
+// Сортирует [first, last) задачами пула и сразу возвращает дескриптор:
+// вызывающий поток не блокируется и не выполняет задач. Если задан
+// deadline, после него задачи останавливаются, как при cancel(), и
+// сортировка завершается со статусом deadline_expired.
+// Дескриптор может пережить пул: деструктор ThreadPool выполняет все
+// поставленные задачи, так что к его концу сортировка завершена.
+// Чтобы прервать её, а не доделать, вызовите cancel() до разрушения пула
+template <typename T, typename Compare>
+SortHandle sort_async(T *first, T *last, Compare comp, ThreadPool &pool,
+                      std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max())
+{
+    std::size_t n = static_cast<std::size_t>(last - first);
+    auto state = std::make_shared<AsyncSortState>(n, deadline);
+
+    if (n < 2)
+    {
+        state->add_finalized(n);
+        state->task_done();
+        return SortHandle(state);
+    }
+
+    int depth_limit = 2 * floor_log2(last - first);
+    pool.submit([=, &pool]
+                { async_sort_task(first, last, comp, depth_limit, true, pool, state); });
+    return SortHandle(state);
+}
+
+#endif // ASYNC_SORT_H
@@ -0,0 +1,51 @@
+#ifndef COMPARE_TRAITS_H
+#define COMPARE_TRAITS_H
+
+#include <functional>
+#include <type_traits>
+
+// Стандартные компараторы над арифметическими типами сравнивают дёшево,
+// без побочных эффектов и задают известный заранее порядок, поэтому для них
+// можно выбирать специализированные алгоритмы на этапе компиляции
+template <typename T, typename Compare>
+struct is_standard_compare : std::false_type
+{
+};
+
+template <typename T>
+struct is_standard_compare<T, std::less<T>> : std::true_type
+{
+};
+
+template <typename T>
+struct is_standard_compare<T, std::greater<T>> : std::true_type
+{
+};
+
+template <typename T>
+struct is_standard_compare<T, std::less<>> : std::true_type
+{
+};
+
+template <typename T>
+struct is_standard_compare<T, std::greater<>> : std::true_type
+{
+};
+
+// Компаратор задаёт порядок по убыванию
+template <typename T, typename Compare>
+struct is_descending_compare : std::false_type
+{
+};
+
+template <typename T>
+struct is_descending_compare<T, std::greater<T>> : std::true_type
+{
+};
+
+template <typename T>
+struct is_descending_compare<T, std::greater<>> : std::true_type
+{
+};
+
+#endif // COMPARE_TRAITS_H
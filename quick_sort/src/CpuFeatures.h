@@ -0,0 +1,34 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+// Векторные ядра собираются атрибутом target и выбираются во время
+// выполнения, поэтому сборка не требует флагов -mavx2/-mavx512f
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SORT_HAS_X86_SIMD 1
+#define SORT_TARGET_AVX2 __attribute__((target("avx2")))
+#define SORT_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define SORT_HAS_X86_SIMD 0
+#endif
+
+inline bool cpu_has_avx2()
+{
+#if SORT_HAS_X86_SIMD
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+#else
+    return false;
+#endif
+}
+
+inline bool cpu_has_avx512()
+{
+#if SORT_HAS_X86_SIMD
+    static const bool has = __builtin_cpu_supports("avx512f");
+    return has;
+#else
+    return false;
+#endif
+}
+
+#endif // CPU_FEATURES_H
@@ -0,0 +1,381 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "KWayMerge.h"
+#include "QuickSort.h"
+
+// Минимальный размер блока чтения одной серии при слиянии: меньшие блоки
+// превращают последовательное чтение в случайное. Он ограничивает число
+// одновременно сливаемых серий, лишние серии сливаются в несколько проходов
+constexpr std::size_t EXTERNAL_SORT_MIN_READ_BYTES = 1 << 20;
+
+// Сколько имён перебирается, если файл серии с таким именем уже есть
+constexpr int EXTERNAL_SORT_CREATE_ATTEMPTS = 16;
+
+struct ExternalSortConfig
+{
+    // Верхняя граница памяти под буферы записей в байтах
+    std::size_t memory_budget = std::size_t(256) << 20;
+    // Каталог для временных файлов серий; пустой — системный
+    std::string temp_directory;
+};
+
+// Временный файл серии, удаляется вместе с объектом
+class ExternalRunFile final
+{
+    std::filesystem::path path_;
+
+public:
+    explicit ExternalRunFile(std::filesystem::path path) : path_(std::move(path)) {}
+
+    ExternalRunFile(const ExternalRunFile &) = delete;
+    ExternalRunFile &operator=(const ExternalRunFile &) = delete;
+
+    ExternalRunFile(ExternalRunFile &&other) noexcept : path_(std::move(other.path_))
+    {
+        other.path_.clear();
+    }
+
+    ~ExternalRunFile()
+    {
+        if (!path_.empty())
+        {
+            std::error_code ignored;
+            std::filesystem::remove(path_, ignored);
+        }
+    }
+
+    const std::filesystem::path &path() const
+    {
+        return path_;
+    }
+};
+
+// Последовательное чтение файла записей блоками фиксированного размера
+template <typename T>
+class ExternalRunReader final
+{
+    std::ifstream in_;
+    std::string name_;
+    std::vector<T> buffer_;
+    std::size_t position_ = 0;
+    std::size_t size_ = 0;
+    std::uint64_t remaining_;
+
+    void refill()
+    {
+        std::size_t count = buffer_.size();
+        if (remaining_ < count)
+            count = static_cast<std::size_t>(remaining_);
+
+        in_.read(reinterpret_cast<char *>(buffer_.data()), static_cast<std::streamsize>(count * sizeof(T)));
+        if (static_cast<std::size_t>(in_.gcount()) != count * sizeof(T))
+            throw std::runtime_error("external_sort: failed to read " + name_);
+
+        remaining_ -= count;
+        position_ = 0;
+        size_ = count;
+    }
+
+public:
+    ExternalRunReader(const std::filesystem::path &path, std::uint64_t records, std::size_t block_records)
+        : in_(path, std::ios::binary), name_(path.string()), buffer_(block_records), remaining_(records)
+    {
+        if (!in_)
+            throw std::runtime_error("external_sort: cannot open " + name_);
+        if (remaining_ > 0)
+            refill();
+    }
+
+    // Текущая запись или nullptr, если файл прочитан
+    const T *current() const
+    {
+        return position_ < size_ ? &buffer_[position_] : nullptr;
+    }
+
+    void advance()
+    {
+        if (++position_ == size_ && remaining_ > 0)
+            refill();
+    }
+};
+
+// Буферизованная запись файла записей
+template <typename T>
+class ExternalRunWriter final
+{
+    std::ofstream out_;
+    std::string name_;
+    std::vector<T> buffer_;
+    std::size_t size_ = 0;
+
+public:
+    ExternalRunWriter(const std::filesystem::path &path, std::size_t block_records)
+        : out_(path, std::ios::binary | std::ios::trunc), name_(path.string()), buffer_(block_records)
+    {
+        if (!out_)
+            throw std::runtime_error("external_sort: cannot create " + name_);
+    }
+
+    void push(const T &record)
+    {
+        buffer_[size_++] = record;
+        if (size_ == buffer_.size())
+            flush();
+    }
+
+    void write(const T *first, const T *last)
+    {
+        flush();
+        out_.write(reinterpret_cast<const char *>(first), static_cast<std::streamsize>((last - first) * sizeof(T)));
+        if (!out_)
+            throw std::runtime_error("external_sort: failed to write " + name_);
+    }
+
+    void flush()
+    {
+        if (size_ == 0)
+            return;
+
+        out_.write(reinterpret_cast<const char *>(buffer_.data()), static_cast<std::streamsize>(size_ * sizeof(T)));
+        if (!out_)
+            throw std::runtime_error("external_sort: failed to write " + name_);
+        size_ = 0;
+    }
+
+    void close()
+    {
+        flush();
+        out_.close();
+        if (!out_)
+            throw std::runtime_error("external_sort: failed to close " + name_);
+    }
+};
+
+struct ExternalRun
+{
+    ExternalRunFile file;
+    std::uint64_t records;
+};
+
+// Создаёт пустой файл серии с уникальным именем. Имя содержит случайную
+// метку процесса и счётчик, а файл создаётся только если его ещё нет
+// (режим "x"), поэтому сортировки с общим temp_directory не затирают
+// серии друг друга: при совпадении берётся следующее имя
+inline ExternalRunFile create_external_run_file(const ExternalSortConfig &config)
+{
+    static const std::uint64_t process_tag =
+        ((std::uint64_t(std::random_device{}()) << 32) | std::random_device{}()) ^
+        static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    static std::atomic<std::uint64_t> counter{0};
+
+    std::filesystem::path directory = config.temp_directory.empty()
+                                          ? std::filesystem::temp_directory_path()
+                                          : std::filesystem::path(config.temp_directory);
+    for (int attempt = 0; attempt < EXTERNAL_SORT_CREATE_ATTEMPTS; ++attempt)
+    {
+        std::filesystem::path path =
+            directory / ("external_sort_" + std::to_string(process_tag) + "_" + std::to_string(counter++) + ".run");
+        if (std::FILE *file = std::fopen(path.string().c_str(), "wbx"))
+        {
+            std::fclose(file);
+            return ExternalRunFile(path);
+        }
+
+        std::error_code ignored;
+        if (!std::filesystem::exists(path, ignored))
+            break;
+    }
+    throw std::runtime_error("external_sort: cannot create a run file in " + directory.string());
+}
+
+// k-путевое слияние серий через merge_sources(). Память: block_records
+// записей на каждую серию и столько же на выходной буфер
+template <typename T, typename Compare>
+void external_merge(std::vector<ExternalRun> &runs, std::size_t first, std::size_t last,
+                    const std::filesystem::path &output, std::size_t block_records, Compare comp)
+{
+    std::vector<ExternalRunReader<T>> readers;
+    readers.reserve(last - first);
+    for (std::size_t i = first; i < last; ++i)
+        readers.emplace_back(runs[i].file.path(), runs[i].records, block_records);
+
+    ExternalRunWriter<T> writer(output, block_records);
+    merge_sources<T>(readers, [&writer](const T &record)
+                     { writer.push(record); },
+                     comp);
+    writer.close();
+}
+
+// Внешняя сортировка файла записей фиксированной ширины. Вход режется на
+// серии по трети бюджета памяти, и ввод-вывод идёт в фоне с обеих сторон:
+// пока sort() упорядочивает одну серию, следующая читается во второй
+// буфер, а предыдущая записывается из третьего. Серии пишутся во
+// временные файлы и сливаются деревом проигравших большими
+// последовательными блоками, при избытке серий — в несколько проходов.
+// Ошибки ввода-вывода выбрасываются как std::runtime_error, временные
+// файлы при этом удаляются
+template <typename T, typename Compare>
+void external_sort(const std::string &input_path, const std::string &output_path, Compare comp,
+                   const ExternalSortConfig &config = ExternalSortConfig())
+{
+    static_assert(std::is_trivially_copyable<T>::value, "external_sort needs fixed-width trivially copyable records");
+
+    std::error_code error;
+    std::uint64_t bytes = std::filesystem::file_size(input_path, error);
+    if (error)
+        throw std::runtime_error("external_sort: cannot open " + input_path);
+    if (bytes % sizeof(T) != 0)
+        throw std::runtime_error("external_sort: size of " + input_path + " is not a multiple of the record size");
+    std::uint64_t total = bytes / sizeof(T);
+
+    // Поразрядной сортировке нужен ещё один буфер размером с серию
+    std::size_t scratch = use_radix_sort<T, Compare> ? 1 : 0;
+    std::uint64_t memory_records = config.memory_budget / ((1 + scratch) * sizeof(T));
+    if (memory_records == 0)
+        throw std::runtime_error("external_sort: memory budget is smaller than a record");
+
+    std::ifstream in(input_path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("external_sort: cannot open " + input_path);
+
+    auto read_chunk = [&in, &input_path](std::vector<T> &chunk, std::uint64_t records)
+    {
+        chunk.resize(static_cast<std::size_t>(records));
+        in.read(reinterpret_cast<char *>(chunk.data()), static_cast<std::streamsize>(records * sizeof(T)));
+        if (static_cast<std::uint64_t>(in.gcount()) != records * sizeof(T))
+            throw std::runtime_error("external_sort: failed to read " + input_path);
+    };
+
+    auto write_run = [](const T *first, const T *last, const std::filesystem::path &path)
+    {
+        ExternalRunWriter<T> writer(path, 0);
+        writer.write(first, last);
+        writer.close();
+    };
+
+    // Всё поместилось в память: временные файлы не нужны
+    if (total <= memory_records)
+    {
+        std::vector<T> all;
+        read_chunk(all, total);
+        sort(all.data(), all.data() + all.size(), comp);
+        write_run(all.data(), all.data() + all.size(), output_path);
+        return;
+    }
+
+    // Три буфера серий: сортируемый, читаемый и записываемый
+    std::size_t run_records = config.memory_budget / ((3 + scratch) * sizeof(T));
+    if (run_records == 0)
+        run_records = 1;
+
+    std::vector<T> current;
+    std::vector<T> next;
+    std::vector<T> spare;
+    current.reserve(run_records);
+    next.reserve(run_records);
+    spare.reserve(run_records);
+
+    std::uint64_t consumed = run_records;
+    read_chunk(current, consumed);
+
+    std::vector<ExternalRun> runs;
+    std::future<void> writing;
+    while (!current.empty())
+    {
+        std::uint64_t left = total - consumed;
+        std::uint64_t next_records = left < run_records ? left : run_records;
+        std::future<void> prefetch = std::async(std::launch::async, read_chunk, std::ref(next), next_records);
+        consumed += next_records;
+
+        try
+        {
+            sort(current.data(), current.data() + current.size(), comp);
+
+            // Буфер spare освобождается, когда дописана предыдущая серия
+            if (writing.valid())
+                writing.get();
+
+            runs.push_back(ExternalRun{create_external_run_file(config), current.size()});
+            // Запись держит указатели на данные: обмен векторов их не меняет
+            writing = std::async(std::launch::async, write_run, current.data(), current.data() + current.size(),
+                                 runs.back().file.path());
+        }
+        catch (...)
+        {
+            prefetch.wait();
+            if (writing.valid())
+                writing.wait();
+            throw;
+        }
+
+        try
+        {
+            prefetch.get();
+        }
+        catch (...)
+        {
+            writing.wait();
+            throw;
+        }
+
+        // Записываемая серия уходит в spare, прочитанная становится текущей
+        std::swap(spare, current);
+        std::swap(current, next);
+    }
+    writing.get();
+    std::vector<T>().swap(current);
+    std::vector<T>().swap(next);
+    std::vector<T>().swap(spare);
+
+    // Каждой сливаемой серии и выходу — блок не меньше EXTERNAL_SORT_MIN_READ_BYTES
+    std::size_t fan_in = config.memory_budget / EXTERNAL_SORT_MIN_READ_BYTES;
+    if (fan_in > 0)
+        --fan_in;
+    if (fan_in < 2)
+        fan_in = 2;
+
+    while (runs.size() > fan_in)
+    {
+        std::vector<ExternalRun> merged;
+        std::size_t block_records = config.memory_budget / ((fan_in + 1) * sizeof(T));
+        if (block_records == 0)
+            block_records = 1;
+
+        for (std::size_t first = 0; first < runs.size(); first += fan_in)
+        {
+            std::size_t last = first + fan_in < runs.size() ? first + fan_in : runs.size();
+            std::uint64_t records = 0;
+            for (std::size_t i = first; i < last; ++i)
+                records += runs[i].records;
+
+            ExternalRun run{create_external_run_file(config), records};
+            external_merge<T>(runs, first, last, run.file.path(), block_records, comp);
+            merged.push_back(std::move(run));
+        }
+        runs = std::move(merged);
+    }
+
+    std::size_t block_records = config.memory_budget / ((runs.size() + 1) * sizeof(T));
+    if (block_records == 0)
+        block_records = 1;
+    external_merge<T>(runs, 0, runs.size(), output_path, block_records, comp);
+}
+
+#endif // EXTERNAL_SORT_H
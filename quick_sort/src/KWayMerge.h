@@ -0,0 +1,146 @@
+#ifndef K_WAY_MERGE_H
+#define K_WAY_MERGE_H
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "LoserTree.h"
+
+// Слияние двух отсортированных диапазонов. Выбор источника не ветвится:
+// результат сравнения сдвигает ровно один из указателей, поэтому
+// непредсказуемые сравнения не срывают конвейер. При равенстве первым
+// идёт элемент из [a, a_last). Элементы неконстантных диапазонов
+// перемещаются, константных — копируются. Возвращает конец записанного
+template <typename T, typename Compare>
+std::remove_const_t<T> *merge_two(T *a, T *a_last, T *b, T *b_last, std::remove_const_t<T> *out, Compare comp)
+{
+    while (a != a_last && b != b_last)
+    {
+        bool take_b = comp(*b, *a);
+        *out++ = take_b ? std::move(*b) : std::move(*a);
+        b += take_b;
+        a += !take_b;
+    }
+
+    while (a != a_last)
+        *out++ = std::move(*a++);
+    while (b != b_last)
+        *out++ = std::move(*b++);
+    return out;
+}
+
+// Серия в памяти как потоковый источник: current() — текущий элемент
+// или nullptr, если серия исчерпана. T может быть константным типом
+template <typename T>
+class RunSource final
+{
+    T *current_;
+    T *last_;
+
+public:
+    RunSource(T *first, T *last) : current_(first), last_(last) {}
+
+    T *current() const
+    {
+        return current_ != last_ ? current_ : nullptr;
+    }
+
+    void advance()
+    {
+        ++current_;
+    }
+};
+
+// k-путевое слияние потоковых источников (методы current() и advance(),
+// как у RunSource) в приёмник sink(*current()). Для k > 2 — дерево
+// проигравших, O(n log k) сравнений. Равные элементы выходят в порядке
+// номеров источников
+template <typename T, typename Source, typename Sink, typename Compare>
+void merge_sources(std::vector<Source> &sources, Sink sink, Compare comp)
+{
+    if (sources.size() == 1)
+    {
+        for (auto *p = sources[0].current(); p; p = sources[0].current())
+        {
+            sink(*p);
+            sources[0].advance();
+        }
+        return;
+    }
+
+    if (sources.size() == 2)
+    {
+        Source &a = sources[0];
+        Source &b = sources[1];
+        auto *x = a.current();
+        auto *y = b.current();
+        while (x && y)
+        {
+            if (comp(*y, *x))
+            {
+                sink(*y);
+                b.advance();
+                y = b.current();
+            }
+            else
+            {
+                sink(*x);
+                a.advance();
+                x = a.current();
+            }
+        }
+        Source &rest = x ? a : b;
+        for (auto *p = rest.current(); p; p = rest.current())
+        {
+            sink(*p);
+            rest.advance();
+        }
+        return;
+    }
+
+    if (sources.empty())
+        return;
+
+    LoserTree<T, Compare> tree(sources.size(), comp);
+    for (std::size_t i = 0; i < sources.size(); ++i)
+        tree.set(i, sources[i].current());
+    tree.init();
+
+    while (!tree.empty())
+    {
+        std::size_t source = tree.winner();
+        sink(*sources[source].current());
+        sources[source].advance();
+        tree.replace_winner(sources[source].current());
+    }
+}
+
+// Слияние k отсортированных серий [runs[i].first, runs[i].second) в out.
+// Две серии сливаются без ветвлений, больше — деревом проигравших.
+// Слияние устойчиво: равные элементы выходят в порядке номеров серий.
+// Из серий с неконстантными элементами элементы перемещаются, что для
+// типов с владением ресурсами (строк) избавляет от копий.
+// Возвращает конец записанного
+template <typename T, typename Compare>
+std::remove_const_t<T> *merge_k(const std::vector<std::pair<T *, T *>> &runs, std::remove_const_t<T> *out,
+                                Compare comp)
+{
+    using Value = std::remove_const_t<T>;
+
+    if (runs.size() == 2)
+        return merge_two(runs[0].first, runs[0].second, runs[1].first, runs[1].second, out, comp);
+
+    std::vector<RunSource<T>> sources;
+    sources.reserve(runs.size());
+    for (const std::pair<T *, T *> &run : runs)
+        sources.emplace_back(run.first, run.second);
+
+    merge_sources<Value>(sources, [&out](T &value)
+                         { *out++ = std::move(value); },
+                         comp);
+    return out;
+}
+
+#endif // K_WAY_MERGE_H
@@ -0,0 +1,116 @@
+#ifndef KEY_SORT_H
+#define KEY_SORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Permutation.h"
+#include "QuickSort.h"
+#include "RadixSort.h"
+
+// Ключ элемента вместе с его исходной позицией
+template <typename Key, typename Index>
+struct KeyIndex
+{
+    Key key;
+    Index index;
+
+    // Для ключей из std (например, std::string) поиск по аргументам находит
+    // и std::swap, и ::swap из QuickSort.h; нешаблонная перегрузка точнее обеих
+    friend void swap(KeyIndex &a, KeyIndex &b)
+    {
+        std::swap(a.key, b.key);
+        std::swap(a.index, b.index);
+    }
+};
+
+// Порядок по ключу, равные ключи — по исходной позиции: так результат
+// не зависит от устойчивости движка сортировки
+template <typename Key, typename Index, typename Compare>
+struct KeyIndexCompare
+{
+    Compare comp;
+
+    bool operator()(const KeyIndex<Key, Index> &a, const KeyIndex<Key, Index> &b) const
+    {
+        if (comp(a.key, b.key))
+            return true;
+        if (comp(b.key, a.key))
+            return false;
+        return a.index < b.index;
+    }
+};
+
+template <typename T, typename Index, typename KeyFunction, typename Compare>
+void sort_by_key_indexed(T *first, T *last, KeyFunction key_fn, Compare comp)
+{
+    using Key = std::decay_t<decltype(key_fn(*first))>;
+    using Entry = KeyIndex<Key, Index>;
+
+    std::size_t n = static_cast<std::size_t>(last - first);
+    std::vector<Entry> entries;
+    entries.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        entries.push_back(Entry{key_fn(first[i]), static_cast<Index>(i)});
+
+    Entry *begin = entries.data();
+    Entry *end = begin + n;
+
+    // Поразрядная сортировка устойчива, поэтому порядок равных ключей
+    // по позиции получается сам собой
+    bool sorted = false;
+    if constexpr (use_radix_sort<Key, Compare>)
+    {
+        if (static_cast<std::ptrdiff_t>(n) >= RADIX_SORT_MIN_SIZE)
+        {
+            if constexpr (is_descending_compare<Key, Compare>::value)
+                sorted = radix_sort_by_key(begin, end, [](const Entry &e)
+                                           { return decltype(to_radix_key(e.key))(~to_radix_key(e.key)); },
+                                           RADIX_SORT_MAX_PASSES);
+            else
+                sorted = radix_sort_by_key(begin, end, [](const Entry &e)
+                                           { return to_radix_key(e.key); },
+                                           RADIX_SORT_MAX_PASSES);
+        }
+    }
+    if (!sorted)
+        sort(begin, end, KeyIndexCompare<Key, Index, Compare>{comp});
+
+    std::vector<Index> order(n);
+    for (std::size_t i = 0; i < n; ++i)
+        order[i] = entries[i].index;
+    std::vector<Entry>().swap(entries);
+
+    apply_permutation_buffered(first, order.data(), n);
+}
+
+// Сортировка по проекции: key_fn вызывается ровно n раз, ключи с исходными
+// позициями сортируются отдельно (целые и плавающие ключи — поразрядно),
+// затем каждый элемент перемещается на своё место один раз (при нехватке
+// памяти — на месте по циклам). Выгодно, когда ключ дорого вычислять или
+// элементы дорого перемещать. Сортировка устойчива
+template <typename T, typename KeyFunction, typename Compare>
+void sort_by_key(T *first, T *last, KeyFunction key_fn, Compare comp)
+{
+    std::ptrdiff_t n = last - first;
+    if (n < 2)
+        return;
+
+    if (static_cast<std::uint64_t>(n) <= UINT32_MAX)
+        sort_by_key_indexed<T, std::uint32_t>(first, last, key_fn, comp);
+    else
+        sort_by_key_indexed<T, std::size_t>(first, last, key_fn, comp);
+}
+
+template <typename T, typename KeyFunction>
+void sort_by_key(T *first, T *last, KeyFunction key_fn)
+{
+    using Key = std::decay_t<decltype(key_fn(*first))>;
+    sort_by_key(first, last, key_fn, std::less<Key>());
+}
+
+#endif // KEY_SORT_H
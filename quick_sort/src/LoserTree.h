@@ -0,0 +1,110 @@
+#ifndef LOSER_TREE_H
+#define LOSER_TREE_H
+
+#include <cstddef>
+#include <vector>
+
+// Дерево проигравших для k-путевого слияния. Листья — источники, во
+// внутренних узлах хранится проигравший в матче поддеревьев, а в узле 0 —
+// общий победитель. После замены ключа победителя переигрывается только путь
+// от его листа к корню: log k сравнений и ни одного с братом-победителем.
+// Ключи не копируются — дерево хранит указатели на текущие элементы
+// источников, nullptr означает исчерпанный источник. При равных ключах
+// побеждает источник с меньшим номером, так что слияние устойчиво
+template <typename T, typename Compare>
+class LoserTree final
+{
+    std::vector<const T *> keys_;
+    std::vector<std::size_t> tree_;
+    std::size_t leaves_;
+    Compare comp_;
+
+    bool beats(std::size_t a, std::size_t b) const
+    {
+        if (!keys_[a])
+            return false;
+        if (!keys_[b])
+            return true;
+        if (comp_(*keys_[a], *keys_[b]))
+            return true;
+        return !comp_(*keys_[b], *keys_[a]) && a < b;
+    }
+
+    std::size_t play_initial(std::size_t node)
+    {
+        if (node >= leaves_)
+            return node - leaves_;
+
+        std::size_t left = play_initial(2 * node);
+        std::size_t right = play_initial(2 * node + 1);
+        if (beats(left, right))
+        {
+            tree_[node] = right;
+            return left;
+        }
+        tree_[node] = left;
+        return right;
+    }
+
+public:
+    explicit LoserTree(std::size_t sources, Compare comp)
+        : leaves_(1), comp_(comp)
+    {
+        while (leaves_ < sources)
+            leaves_ *= 2;
+
+        keys_.assign(leaves_, nullptr);
+        tree_.assign(leaves_, 0);
+    }
+
+    std::size_t size() const
+    {
+        return leaves_;
+    }
+
+    // Начальный ключ источника; после установки всех ключей вызывается init()
+    void set(std::size_t source, const T *key)
+    {
+        keys_[source] = key;
+    }
+
+    void init()
+    {
+        tree_[0] = leaves_ > 1 ? play_initial(1) : 0;
+    }
+
+    bool empty() const
+    {
+        return keys_[tree_[0]] == nullptr;
+    }
+
+    std::size_t winner() const
+    {
+        return tree_[0];
+    }
+
+    const T &top() const
+    {
+        return *keys_[tree_[0]];
+    }
+
+    // Заменяет ключ победителя следующим элементом его источника
+    void replace_winner(const T *key)
+    {
+        std::size_t current = tree_[0];
+        keys_[current] = key;
+
+        for (std::size_t node = (current + leaves_) / 2; node > 0; node /= 2)
+        {
+            if (beats(tree_[node], current))
+            {
+                std::size_t loser = current;
+                current = tree_[node];
+                tree_[node] = loser;
+            }
+        }
+        tree_[0] = current;
+    }
+};
+
+#endif // LOSER_TREE_H
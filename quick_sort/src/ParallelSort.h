@@ -0,0 +1,102 @@
+#ifndef PARALLEL_SORT_H
+#define PARALLEL_SORT_H
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "QuickSort.h"
+#include "ThreadPool.h"
+
+// Диапазоны не длиннее этого порога сортируются последовательным sort()
+constexpr std::ptrdiff_t PARALLEL_SORT_GRAIN = 1 << 15;
+
+struct ParallelSortState
+{
+    std::atomic<std::ptrdiff_t> pending{0};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+};
+
+template <typename T, typename Compare>
+void parallel_quicksort_task(T *first, T *last, Compare comp, int depth_limit, bool leftmost,
+                             ThreadPool &pool, ParallelSortState &state)
+{
+    try
+    {
+        while (last - first > PARALLEL_SORT_GRAIN)
+        {
+            if (depth_limit == 0)
+            {
+                heap_sort(first, last, comp);
+                first = last;
+                break;
+            }
+            --depth_limit;
+
+            T *middle = first + (last - first) / 2;
+            T *pivot = choose_pivot<SortTraits<T, Compare>>(first, last, comp);
+
+            // [lo, hi) после разбиения уже стоят на своих местах
+            T *lo, *hi;
+            if (many_duplicates(first, middle, last, pivot, comp, leftmost))
+            {
+                std::pair<T *, T *> equal = partition_three_way(first, last, pivot, comp);
+                lo = equal.first;
+                hi = equal.second;
+            }
+            else
+            {
+                lo = partition_with<SortTraits<T, Compare>>(first, last, pivot, comp).first;
+                hi = lo + 1;
+            }
+
+            ++state.pending;
+            pool.submit([=, &pool, &state]
+                        { parallel_quicksort_task(hi, last, comp, depth_limit, false, pool, state); });
+            last = lo;
+        }
+
+        sort(first, last, comp);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(state.error_mutex);
+        if (!state.error)
+            state.error = std::current_exception();
+    }
+
+    --state.pending;
+}
+
+// Параллельная быстрая сортировка: правые половины разбиений крупнее
+// PARALLEL_SORT_GRAIN становятся задачами пула, левые обрабатываются на месте.
+// Вызывающий поток тоже выполняет задачи, пока сортировка не завершится,
+// поэтому parallel_sort() можно вызывать и из задачи того же пула
+template <typename T, typename Compare>
+void parallel_sort(T *first, T *last, Compare comp, ThreadPool &pool)
+{
+    if (last - first <= PARALLEL_SORT_GRAIN)
+    {
+        sort(first, last, comp);
+        return;
+    }
+
+    ParallelSortState state;
+    state.pending = 1;
+    parallel_quicksort_task(first, last, comp, 2 * floor_log2(last - first), true, pool, state);
+
+    while (state.pending > 0)
+    {
+        if (!pool.run_pending_task())
+            std::this_thread::yield();
+    }
+
+    if (state.error)
+        std::rethrow_exception(state.error);
+}
+
+#endif // PARALLEL_SORT_H
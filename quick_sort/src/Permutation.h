@@ -0,0 +1,76 @@
+#ifndef PERMUTATION_H
+#define PERMUTATION_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// Переставляет элементы на месте так, что на позицию i встаёт элемент,
+// стоявший на позиции order[i]. Перестановка обходится по циклам: каждый
+// элемент перемещается ровно один раз, плюс одно перемещение на цикл.
+// order используется как пометка пройденных позиций и портится
+template <typename T, typename Index>
+void apply_permutation(T *first, Index *order, std::size_t n)
+{
+    for (std::size_t start = 0; start < n; ++start)
+    {
+        if (static_cast<std::size_t>(order[start]) == start)
+            continue;
+
+        T temp = std::move(first[start]);
+        std::size_t current = start;
+        while (true)
+        {
+            std::size_t source = static_cast<std::size_t>(order[current]);
+            order[current] = static_cast<Index>(current);
+            if (source == start)
+            {
+                first[current] = std::move(temp);
+                break;
+            }
+
+            first[current] = std::move(first[source]);
+            current = source;
+        }
+    }
+}
+
+// То же через буфер на n элементов: элементы собираются по order с
+// последовательной записью. Чтения здесь независимы и идут параллельно,
+// тогда как обход циклов — цепочка зависимых промахов кэша, поэтому на
+// больших массивах это в несколько раз быстрее. Буфер выравнивается по
+// alignof(T), так что подходит и для типов с повышенным выравниванием.
+// Если буфер выделить не удалось, перестановка выполняется на месте
+template <typename T, typename Index>
+void apply_permutation_buffered(T *first, Index *order, std::size_t n)
+{
+    T *buffer = static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignof(T)), std::nothrow));
+    if (!buffer)
+    {
+        apply_permutation(first, order, n);
+        return;
+    }
+
+    std::size_t constructed = 0;
+    try
+    {
+        for (; constructed < n; ++constructed)
+            new (buffer + constructed) T(std::move(first[static_cast<std::size_t>(order[constructed])]));
+
+        for (std::size_t i = 0; i < n; ++i)
+            first[i] = std::move(buffer[i]);
+    }
+    catch (...)
+    {
+        for (std::size_t i = 0; i < constructed; ++i)
+            buffer[i].~T();
+        ::operator delete(buffer, std::align_val_t(alignof(T)));
+        throw;
+    }
+
+    for (std::size_t i = 0; i < n; ++i)
+        buffer[i].~T();
+    ::operator delete(buffer, std::align_val_t(alignof(T)));
+}
+
+#endif // PERMUTATION_H
@@ -1,5 +1,37 @@
+#ifndef QUICK_SORT_H
+#define QUICK_SORT_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "CompareTraits.h"
+#include "Permutation.h"
+#include "RadixSort.h"
+#include "SimdPartition.h"
+#include "SortStats.h"
+#include "SortTraits.h"
+#include "SortingNetwork.h"
+#include "StringSort.h"
+
 constexpr int INSERTION_SORT_QUANT = 16;
+constexpr int PARTITION_BLOCK_SIZE = 64;
+constexpr int PARTIAL_INSERTION_SORT_LIMIT = 8;
+// Для PivotStrategy::ninther и adaptive: на меньших диапазонах берётся
+// медиана трёх
+constexpr std::ptrdiff_t PIVOT_NINTHER_THRESHOLD = 128;
+// Для PivotStrategy::adaptive: на больших диапазонах опорный элемент —
+// медиана выборки из sqrt(n) элементов, собираемой блоками по кэш-линии
+constexpr std::ptrdiff_t PIVOT_SAMPLE_THRESHOLD = 1 << 16;
+constexpr std::size_t PIVOT_SAMPLE_LINE_BYTES = 64;
+// Записи от этого размера в байтах sort() упорядочивает косвенно
+constexpr std::size_t INDIRECT_SORT_MIN_BYTES = 512;
 
 template <typename T>
 inline void swap(T &a, T &b)
@@ -9,6 +41,14 @@ inline void swap(T &a, T &b)
     b = std::move(tmp);
 }
 
+// Обмен, учитываемый в статистике сортировки, если comp её несёт (SortStats.h)
+template <typename T, typename Compare>
+inline void counted_swap(T &a, T &b, const Compare &comp)
+{
+    sort_stats(comp).on_swap();
+    swap(a, b);
+}
+
 template <typename T, typename Compare>
 void insertion_sort(T *first, T *last, Compare comp)
 {
@@ -27,7 +67,53 @@ void insertion_sort(T *first, T *last, Compare comp)
         }
 
         *j = std::move(temp);
+        sort_stats(comp).on_move(static_cast<std::uint64_t>(i - j) + 2);
+    }
+}
+
+// Базовый случай для диапазонов до Traits::insertion_sort_quant: для
+// арифметических типов — сеть сортировки без ветвлений, иначе сортировка вставками
+template <typename T, typename Compare, typename Traits = SortTraits<T, Compare>>
+void small_sort(T *first, T *last, Compare comp)
+{
+    if constexpr (use_sorting_network<T, Compare> && Traits::insertion_sort_quant <= SORTING_NETWORK_MAX_SIZE)
+        sorting_network_sort(first, last, comp);
+    else
+        insertion_sort(first, last, comp);
+}
+
+// Сортировка вставками, которая сдаётся, как только суммарное смещение
+// элементов превысит PARTIAL_INSERTION_SORT_LIMIT. Возвращает true, если
+// диапазон отсортирован. Почти упорядоченные диапазоны досортировываются за O(n)
+template <typename T, typename Compare>
+bool partial_insertion_sort(T *first, T *last, Compare comp)
+{
+    if (first == last)
+        return true;
+
+    std::ptrdiff_t moves = 0;
+    for (T *i = first + 1; i != last; ++i)
+    {
+        if (!comp(*i, *(i - 1)))
+            continue;
+
+        T temp = std::move(*i);
+        T *j = i;
+
+        do
+        {
+            *j = std::move(*(j - 1));
+            --j;
+        } while (j > first && comp(temp, *(j - 1)));
+
+        *j = std::move(temp);
+        sort_stats(comp).on_move(static_cast<std::uint64_t>(i - j) + 2);
+        moves += i - j;
+        if (moves > PARTIAL_INSERTION_SORT_LIMIT)
+            return false;
     }
+
+    return true;
 }
 
 template <typename T, typename Compare>
@@ -54,48 +140,596 @@ T *median_of_three(T *a, T *b, T *c, Compare comp)
 template <typename T, typename Compare>
 T *partition(T *first, T *last, T *pivot, Compare comp)
 {
-    swap(*pivot, *(last - 1));
+    counted_swap(*pivot, *(last - 1), comp);
     T *store = first;
 
     for (T *p = first; p != last - 1; ++p)
     {
         if (comp(*p, *(last - 1)))
         {
-            swap(*p, *store);
+            counted_swap(*p, *store, comp);
             ++store;
         }
     }
 
-    swap(*store, *(last - 1));
+    counted_swap(*store, *(last - 1), comp);
     return store;
 }
 
+// Разбиение Хоара с опорным элементом в начале диапазона: меньшие опорного
+// слева, не меньшие справа. Второе значение — true, если диапазон уже был
+// разбит и не понадобилось ни одного обмена
 template <typename T, typename Compare>
-void quicksort(T *first, T *last, Compare comp)
+std::pair<T *, bool> partition_right(T *first, T *last, T *pivot, Compare comp)
 {
-    while (last - first > 1)
+    counted_swap(*pivot, *first, comp);
+    T value = std::move(*first);
+
+    T *l = first + 1;
+    T *r = last;
+
+    while (l < r && comp(*l, value))
+        ++l;
+    while (l < r && !comp(*(r - 1), value))
+        --r;
+
+    bool already_partitioned = l == r;
+
+    while (l < r)
+    {
+        counted_swap(*l, *(r - 1), comp);
+        ++l;
+        --r;
+
+        while (l < r && comp(*l, value))
+            ++l;
+        while (l < r && !comp(*(r - 1), value))
+            --r;
+    }
+
+    T *pos = l - 1;
+    *first = std::move(*pos);
+    *pos = std::move(value);
+    sort_stats(comp).on_move(3);
+    return {pos, already_partitioned};
+}
+
+// Для арифметических типов со стандартными компараторами выгодно
+// разбиение без ветвлений
+template <typename T, typename Compare>
+constexpr bool use_block_partition = std::is_arithmetic<T>::value && is_standard_compare<T, Compare>::value;
+
+// Блочное разбиение (BlockQuicksort, Edelkamp & Weiß): результаты сравнений
+// записываются смещениями в буферы на стеке без условных переходов,
+// а затем неправильно расположенные элементы обмениваются пачкой.
+// Контракт тот же, что у partition_right()
+template <typename T, typename Compare>
+std::pair<T *, bool> block_partition(T *first, T *last, T *pivot, Compare comp)
+{
+    counted_swap(*pivot, *first, comp);
+    T value = std::move(*first);
+
+    T *l = first + 1;
+    T *r = last;
+
+    while (l < r && comp(*l, value))
+        ++l;
+    while (l < r && !comp(*(r - 1), value))
+        --r;
+
+    bool already_partitioned = l == r;
+    if (!already_partitioned)
+    {
+        counted_swap(*l, *(r - 1), comp);
+        ++l;
+        --r;
+    }
+
+    unsigned char offsets_l[PARTITION_BLOCK_SIZE];
+    unsigned char offsets_r[PARTITION_BLOCK_SIZE];
+    int start_l = 0, start_r = 0;
+    int num_l = 0, num_r = 0;
+
+    while (r - l >= 2 * PARTITION_BLOCK_SIZE)
     {
-        if (last - first <= INSERTION_SORT_QUANT)
+        if (num_l == 0)
         {
-            insertion_sort(first, last, comp);
+            start_l = 0;
+            for (int i = 0; i < PARTITION_BLOCK_SIZE; ++i)
+            {
+                offsets_l[num_l] = static_cast<unsigned char>(i);
+                num_l += !comp(l[i], value);
+            }
+        }
+        if (num_r == 0)
+        {
+            start_r = 0;
+            for (int i = 0; i < PARTITION_BLOCK_SIZE; ++i)
+            {
+                offsets_r[num_r] = static_cast<unsigned char>(i + 1);
+                num_r += comp(*(r - i - 1), value);
+            }
+        }
+
+        int num = num_l < num_r ? num_l : num_r;
+        sort_stats(comp).on_swap(static_cast<std::uint64_t>(num));
+        for (int i = 0; i < num; ++i)
+            swap(l[offsets_l[start_l + i]], *(r - offsets_r[start_r + i]));
+
+        num_l -= num;
+        num_r -= num;
+        start_l += num;
+        start_r += num;
+
+        if (num_l == 0)
+            l += PARTITION_BLOCK_SIZE;
+        if (num_r == 0)
+            r -= PARTITION_BLOCK_SIZE;
+    }
+
+    // Остаток (включая недообработанный блок) разбивается схемой Хоара
+    while (true)
+    {
+        while (l < r && comp(*l, value))
+            ++l;
+        while (l < r && !comp(*(r - 1), value))
+            --r;
+        if (l == r)
+            break;
+
+        counted_swap(*l, *(r - 1), comp);
+        ++l;
+        --r;
+    }
+
+    T *pos = l - 1;
+    *first = std::move(*pos);
+    *pos = std::move(value);
+    sort_stats(comp).on_move(3);
+    return {pos, already_partitioned};
+}
+
+// Лучшее доступное разбиение: векторное, если процессор поддерживает
+// AVX2/AVX-512, иначе блочное или обычное разбиение Хоара
+template <typename T, typename Compare>
+std::pair<T *, bool> partition_auto(T *first, T *last, T *pivot, Compare comp)
+{
+    if constexpr (use_simd_partition<T, Compare>)
+    {
+        if (simd_partition_available<T, Compare>())
+            return simd_partition(first, last, pivot, comp);
+    }
+
+    if constexpr (use_block_partition<T, Compare>)
+        return block_partition(first, last, pivot, comp);
+    else
+        return partition_right(first, last, pivot, comp);
+}
+
+// Разбиение по схеме Traits::partition
+template <typename Traits, typename T, typename Compare>
+std::pair<T *, bool> partition_with(T *first, T *last, T *pivot, Compare comp)
+{
+    if constexpr (Traits::partition == PartitionScheme::hoare)
+        return partition_right(first, last, pivot, comp);
+    else if constexpr (Traits::partition == PartitionScheme::block)
+        return block_partition(first, last, pivot, comp);
+    else
+        return partition_auto(first, last, pivot, comp);
+}
+
+template <typename T, typename Compare>
+bool equivalent(const T &a, const T &b, Compare comp)
+{
+    return !comp(a, b) && !comp(b, a);
+}
+
+// Трёхпутевое разбиение Бентли–Макилроя: равные опорному элементы копятся
+// по краям, а в конце переносятся в середину. Возвращает [lt, gt) —
+// диапазон элементов, равных опорному
+template <typename T, typename Compare>
+std::pair<T *, T *> partition_three_way(T *first, T *last, T *pivot, Compare comp)
+{
+    counted_swap(*pivot, *first, comp);
+    const T &value = *first;
+
+    T *a = first + 1, *b = first + 1;
+    T *c = last - 1, *d = last - 1;
+
+    while (true)
+    {
+        while (b <= c && !comp(value, *b))
+        {
+            if (!comp(*b, value))
+            {
+                counted_swap(*a, *b, comp);
+                ++a;
+            }
+            ++b;
+        }
+        while (b <= c && !comp(*c, value))
+        {
+            if (!comp(value, *c))
+            {
+                counted_swap(*c, *d, comp);
+                --d;
+            }
+            --c;
+        }
+        if (b > c)
+            break;
+
+        counted_swap(*b, *c, comp);
+        ++b;
+        --c;
+    }
+
+    T *lt = b - (a - first);
+    T *gt = last - (d - c);
+
+    for (T *l = first, *r = b - 1; l < a && r >= a; ++l, --r)
+        counted_swap(*l, *r, comp);
+    for (T *l = b, *r = last - 1; r > d && l <= d; ++l, --r)
+        counted_swap(*l, *r, comp);
+
+    return {lt, gt};
+}
+
+template <typename T, typename Compare>
+void sift_down(T *first, std::ptrdiff_t size, std::ptrdiff_t root, Compare comp)
+{
+    while (true)
+    {
+        std::ptrdiff_t child = 2 * root + 1;
+        if (child >= size)
+            return;
+
+        if (child + 1 < size && comp(first[child], first[child + 1]))
+            ++child;
+
+        if (!comp(first[root], first[child]))
             return;
+
+        counted_swap(first[root], first[child], comp);
+        root = child;
+    }
+}
+
+template <typename T, typename Compare>
+void heap_sort(T *first, T *last, Compare comp)
+{
+    std::ptrdiff_t size = last - first;
+
+    for (std::ptrdiff_t i = size / 2 - 1; i >= 0; --i)
+        sift_down(first, size, i, comp);
+
+    for (std::ptrdiff_t end = size - 1; end > 0; --end)
+    {
+        counted_swap(first[0], first[end], comp);
+        sift_down(first, end, 0, comp);
+    }
+}
+
+inline int floor_log2(std::ptrdiff_t n)
+{
+    int log = 0;
+    while (n > 1)
+    {
+        n >>= 1;
+        ++log;
+    }
+    return log;
+}
+
+// Медиана выборки из ~sqrt(n) элементов. Выборка берётся блоками по
+// кэш-линии, равномерно разнесёнными по диапазону, и переносится в его
+// начало, где сортируется пирамидой: промахов кэша — по одному на блок,
+// а сравнений O(sqrt(n) log n) против n на само разбиение
+template <typename T, typename Compare>
+T *sample_pivot(T *first, T *last, Compare comp)
+{
+    std::ptrdiff_t size = last - first;
+    std::ptrdiff_t block = PIVOT_SAMPLE_LINE_BYTES > sizeof(T) ? PIVOT_SAMPLE_LINE_BYTES / sizeof(T) : 1;
+    std::ptrdiff_t blocks = static_cast<std::ptrdiff_t>(std::sqrt(static_cast<double>(size))) / block;
+    if (blocks < 3)
+        blocks = 3;
+    std::ptrdiff_t stride = size / blocks;
+
+    // Блок i переносится на позицию i * block; источник i * stride >= i * block
+    // не пересекается с уже собранными блоками
+    for (std::ptrdiff_t i = 1; i < blocks; ++i)
+    {
+        T *source = first + i * stride;
+        T *target = first + i * block;
+        for (std::ptrdiff_t j = 0; j < block; ++j)
+            counted_swap(target[j], source[j], comp);
+    }
+
+    T *sample_last = first + blocks * block;
+    heap_sort(first, sample_last, comp);
+    return first + blocks * block / 2;
+}
+
+// Опорный элемент по стратегии Traits::pivot
+template <typename Traits, typename T, typename Compare>
+T *choose_pivot(T *first, T *last, Compare comp)
+{
+    std::ptrdiff_t size = last - first;
+    T *middle = first + size / 2;
+
+    if constexpr (Traits::pivot == PivotStrategy::adaptive)
+    {
+        if (size > PIVOT_SAMPLE_THRESHOLD)
+            return sample_pivot(first, last, comp);
+    }
+
+    if constexpr (Traits::pivot == PivotStrategy::ninther || Traits::pivot == PivotStrategy::adaptive)
+    {
+        if (size > PIVOT_NINTHER_THRESHOLD)
+        {
+            std::ptrdiff_t step = size / 8;
+            T *a = median_of_three(first, first + step, first + 2 * step, comp);
+            T *b = median_of_three(middle - step, middle, middle + step, comp);
+            T *c = median_of_three(last - 1 - 2 * step, last - 1 - step, last - 1, comp);
+            return median_of_three(a, b, c, comp);
         }
+    }
 
-        T *middle = first + (last - first) / 2;
-        T *pivot = median_of_three(first, middle, last - 1, comp);
-        T *p = partition(first, last, pivot, comp);
+    return median_of_three(first, middle, last - 1, comp);
+}
 
-        if (p - first < last - p - 1)
+// Опорный элемент совпал с соседом по выборке или с предшественником
+// диапазона (он не больше всех элементов диапазона) — дубликатов много
+template <typename T, typename Compare>
+bool many_duplicates(T *first, T *middle, T *last, T *pivot, Compare comp, bool leftmost)
+{
+    return (!leftmost && !comp(*(first - 1), *pivot)) ||
+           (pivot != first && equivalent(*pivot, *first, comp)) ||
+           (pivot != last - 1 && equivalent(*pivot, *(last - 1), comp)) ||
+           (pivot != middle && equivalent(*pivot, *middle, comp));
+}
+
+template <typename T>
+void reverse(T *first, T *last)
+{
+    while (first < last - 1)
+    {
+        --last;
+        swap(*first, *last);
+        ++first;
+    }
+}
+
+// Интроспективная сортировка: после depth_limit неудачных уровней разбиения
+// диапазон досортировывается пирамидой, что гарантирует O(n log n).
+// При большом числе дубликатов используется трёхпутевое разбиение,
+// исключающее равные опорному элементы из рекурсии.
+// Как в pdqsort, разбиение без единого обмена намекает на упорядоченные
+// данные и проверяется частичной сортировкой вставками, а сильно
+// несбалансированное разбиение ломает шаблон перестановкой нескольких элементов
+template <typename T, typename Compare, typename Traits = SortTraits<T, Compare>>
+void introsort_loop(T *first, T *last, Compare comp, int depth_limit, bool leftmost = true)
+{
+    while (last - first > Traits::insertion_sort_quant)
+    {
+        if (depth_limit == 0)
         {
-            quicksort(first, p, comp);
+            sort_stats(comp).on_heap_sort();
+            heap_sort(first, last, comp);
+            return;
+        }
+        --depth_limit;
+
+        std::ptrdiff_t size = last - first;
+        T *middle = first + size / 2;
+        T *pivot = choose_pivot<Traits>(first, last, comp);
+
+        if (many_duplicates(first, middle, last, pivot, comp, leftmost))
+        {
+            std::pair<T *, T *> equal = partition_three_way(first, last, pivot, comp);
+            sort_stats(comp).on_three_way_partition(depth_limit, size, equal.first - first, last - equal.second);
+
+            if (equal.first - first < last - equal.second)
+            {
+                introsort_loop<T, Compare, Traits>(first, equal.first, comp, depth_limit, leftmost);
+                first = equal.second;
+                leftmost = false;
+            }
+            else
+            {
+                introsort_loop<T, Compare, Traits>(equal.second, last, comp, depth_limit, false);
+                last = equal.first;
+            }
+            continue;
+        }
+
+        std::pair<T *, bool> part = partition_with<Traits>(first, last, pivot, comp);
+
+        T *p = part.first;
+        std::ptrdiff_t l_size = p - first;
+        std::ptrdiff_t r_size = last - (p + 1);
+        sort_stats(comp).on_partition(depth_limit, size, l_size, r_size);
+
+        if (l_size < size / 8 || r_size < size / 8)
+        {
+            if (l_size >= Traits::insertion_sort_quant)
+            {
+                counted_swap(*first, *(first + l_size / 4), comp);
+                counted_swap(*(p - 1), *(p - l_size / 4), comp);
+            }
+            if (r_size >= Traits::insertion_sort_quant)
+            {
+                counted_swap(*(p + 1), *(p + 1 + r_size / 4), comp);
+                counted_swap(*(last - 1), *(last - r_size / 4), comp);
+            }
+        }
+        else if (part.second && partial_insertion_sort(first, p, comp) &&
+                 partial_insertion_sort(p + 1, last, comp))
+        {
+            return;
+        }
+
+        if (l_size < r_size)
+        {
+            introsort_loop<T, Compare, Traits>(first, p, comp, depth_limit, leftmost);
             first = p + 1;
+            leftmost = false;
         }
         else
         {
-            quicksort(p + 1, last, comp);
+            introsort_loop<T, Compare, Traits>(p + 1, last, comp, depth_limit, false);
             last = p;
         }
     }
+
+    sort_stats(comp).on_insertion_sort();
+    small_sort<T, Compare, Traits>(first, last, comp);
+}
+
+// Отсортированный хвост [middle, last) вливается в отсортированную часть
+// [first, middle) с конца: перемещаются только элементы, большие минимума хвоста
+template <typename T, typename Compare>
+void merge_sorted_tail(T *first, T *middle, T *last, Compare comp)
+{
+    std::vector<T> tail;
+    tail.reserve(last - middle);
+    for (T *p = middle; p != last; ++p)
+        tail.push_back(std::move(*p));
+    sort_stats(comp).on_move(static_cast<std::uint64_t>(last - middle));
+
+    T *head = middle;
+    T *out = last;
+    while (!tail.empty())
+    {
+        if (head != first && comp(tail.back(), *(head - 1)))
+        {
+            *--out = std::move(*--head);
+        }
+        else
+        {
+            *--out = std::move(tail.back());
+            tail.pop_back();
+        }
+        sort_stats(comp).on_move();
+    }
+}
+
+// quicksort() с явно заданными настройками Traits (см. SortTraits)
+template <typename Traits, typename T, typename Compare>
+void quicksort_tuned(T *first, T *last, Compare comp)
+{
+    if (last - first < 2)
+        return;
+
+    // Убывающая серия в начале разворачивается: обратно упорядоченный
+    // вход становится отсортированным, а почти обратный — почти отсортированным
+    T *run = first + 1;
+    while (run != last && comp(*run, *(run - 1)))
+        ++run;
+    if (run - first > Traits::insertion_sort_quant)
+    {
+        sort_stats(comp).on_swap(static_cast<std::uint64_t>(run - first) / 2);
+        reverse(first, run);
+    }
+    else
+        run = first + 1;
+
+    // Отсортированный вход и вход с несколькими дописанными в конец
+    // элементами обрабатываются за O(n + k log k)
+    while (run != last && !comp(*run, *(run - 1)))
+        ++run;
+    if (run == last)
+        return;
+    if (last - run <= (run - first) / 8)
+    {
+        sort_stats(comp).on_start(2 * floor_log2(last - run));
+        introsort_loop<T, Compare, Traits>(run, last, comp, 2 * floor_log2(last - run));
+        merge_sorted_tail(first, run, last, comp);
+        return;
+    }
+
+    sort_stats(comp).on_start(2 * floor_log2(last - first));
+    introsort_loop<T, Compare, Traits>(first, last, comp, 2 * floor_log2(last - first));
+}
+
+template <typename T, typename Compare>
+void quicksort(T *first, T *last, Compare comp)
+{
+    quicksort_tuned<SortTraits<T, Compare>>(first, last, comp);
+}
+
+// quicksort() со счётчиками операций: компаратор оборачивается в
+// InstrumentedCompare, а алгоритм и настройки остаются теми же, что у
+// quicksort() с исходным компаратором. Без обёртки счётчики не компилируются
+template <typename T, typename Compare>
+SortStats quicksort_with_stats(T *first, T *last, Compare comp)
+{
+    SortStats stats;
+    quicksort_tuned<SortTraits<T, Compare>>(first, last, InstrumentedCompare<Compare>{comp, &stats});
+    return stats;
+}
+
+// Сравнение элементов по их индексам в base
+template <typename T, typename Index, typename Compare>
+struct IndirectCompare
+{
+    const T *base;
+    Compare comp;
+
+    bool operator()(Index a, Index b) const
+    {
+        return comp(base[a], base[b]);
+    }
+};
+
+// Перестановка, упорядочивающая диапазон: order[i] — индекс элемента,
+// который стоит i-м после сортировки. Сами элементы не перемещаются
+template <typename T, typename Index, typename Compare>
+void argsort(const T *first, const T *last, Index *order, Compare comp)
+{
+    std::size_t n = static_cast<std::size_t>(last - first);
+    for (std::size_t i = 0; i < n; ++i)
+        order[i] = static_cast<Index>(i);
+
+    quicksort(order, order + n, IndirectCompare<T, Index, Compare>{first, comp});
+}
+
+template <typename Index = std::uint32_t, typename T, typename Compare>
+std::vector<Index> argsort(const T *first, const T *last, Compare comp)
+{
+    static_assert(std::is_integral<Index>::value && std::is_unsigned<Index>::value, "argsort needs an unsigned index type");
+
+    std::size_t n = static_cast<std::size_t>(last - first);
+    if (n > 0 && n - 1 > static_cast<std::size_t>(std::numeric_limits<Index>::max()))
+        throw std::length_error("argsort: index type is too narrow for the range");
+
+    std::vector<Index> order(n);
+    argsort(first, last, order.data(), comp);
+    return order;
+}
+
+// Крупные записи и типы, перемещение которых может бросить исключение
+// (обычно это значит, что оно сводится к копированию), дешевле сортировать
+// косвенно: упорядочить индексы, а затем переставить каждую запись один раз
+template <typename T>
+constexpr bool use_indirect_sort = sizeof(T) >= INDIRECT_SORT_MIN_BYTES ||
+                                   !std::is_nothrow_move_constructible<T>::value ||
+                                   !std::is_nothrow_move_assignable<T>::value;
+
+template <typename T, typename Compare>
+void indirect_sort(T *first, T *last, Compare comp)
+{
+    std::size_t n = static_cast<std::size_t>(last - first);
+    if (n <= std::numeric_limits<std::uint32_t>::max())
+    {
+        std::vector<std::uint32_t> order = argsort<std::uint32_t>(first, last, comp);
+        apply_permutation(first, order.data(), n);
+    }
+    else
+    {
+        std::vector<std::uint64_t> order = argsort<std::uint64_t>(first, last, comp);
+        apply_permutation(first, order.data(), n);
+    }
 }
 
 template <typename T, typename Compare>
@@ -105,7 +739,35 @@ void sort(T *first, T *last, Compare comp)
     {
         return;
     }
-    quicksort(first, last, comp);
+
+    if constexpr (use_radix_sort<T, Compare>)
+    {
+        if (last - first >= RADIX_SORT_MIN_SIZE && radix_sort(first, last, comp, RADIX_SORT_MAX_PASSES))
+            return;
+    }
+
+    if constexpr (use_indirect_sort<T>)
+    {
+        if (last - first > SortTraits<T, Compare>::insertion_sort_quant)
+        {
+            indirect_sort(first, last, comp);
+            return;
+        }
+    }
+
+    // Ветка quicksort() для строк не инстанцируется: std::string_view
+    // не обменивается через ::swap из-за неоднозначности с std::swap
+    if constexpr (use_string_sort<T, Compare>)
+    {
+        if (last - first > SortTraits<T, Compare>::insertion_sort_quant)
+            string_sort(first, last, comp);
+        else
+            insertion_sort(first, last, comp);
+    }
+    else
+    {
+        quicksort(first, last, comp);
+    }
 }
 
 template <typename T, typename Compare>
@@ -130,3 +792,5 @@ void quicksort_no_insertion(T *first, T *last, Compare comp)
         }
     }
 }
+
+#endif // QUICK_SORT_H
@@ -0,0 +1,176 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "CompareTraits.h"
+
+// Меньше этого размера гистограммы поразрядной сортировки не окупаются,
+// а больше RADIX_SORT_MAX_PASSES проходов (случайные 64-битные ключи)
+// проигрывают quicksort()
+constexpr std::ptrdiff_t RADIX_SORT_MIN_SIZE = 512;
+constexpr int RADIX_SORT_MAX_PASSES = 5;
+
+template <typename T>
+constexpr bool is_radix_key = (std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                               sizeof(T) <= 8) ||
+                              (std::is_floating_point<T>::value && (sizeof(T) == 4 || sizeof(T) == 8));
+
+template <typename T, typename Compare>
+constexpr bool use_radix_sort = is_radix_key<T> && is_standard_compare<T, Compare>::value;
+
+// Беззнаковый ключ той же ширины, что и T
+template <typename T, std::size_t Size = sizeof(T)>
+struct radix_unsigned;
+
+template <typename T>
+struct radix_unsigned<T, 1>
+{
+    using type = std::uint8_t;
+};
+
+template <typename T>
+struct radix_unsigned<T, 2>
+{
+    using type = std::uint16_t;
+};
+
+template <typename T>
+struct radix_unsigned<T, 4>
+{
+    using type = std::uint32_t;
+};
+
+template <typename T>
+struct radix_unsigned<T, 8>
+{
+    using type = std::uint64_t;
+};
+
+// Отображение значения в беззнаковый ключ с тем же порядком: у знаковых
+// целых инвертируется знаковый бит, у чисел IEEE-754 отрицательные значения
+// инвертируются целиком, а у неотрицательных выставляется знаковый бит
+template <typename T>
+typename radix_unsigned<T>::type to_radix_key(T value)
+{
+    using Key = typename radix_unsigned<T>::type;
+    constexpr Key sign_bit = Key(1) << (8 * sizeof(T) - 1);
+
+    Key key;
+    std::memcpy(&key, &value, sizeof(T));
+
+    if constexpr (std::is_floating_point<T>::value)
+        return (key & sign_bit) ? Key(~key) : Key(key | sign_bit);
+    else if constexpr (std::is_signed<T>::value)
+        return Key(key ^ sign_bit);
+    else
+        return key;
+}
+
+// LSD-сортировка по беззнаковому ключу key(element). Разряды по 11 бит
+// для ключей от 32 бит и по 8 бит для более коротких. Проходы, в которых
+// у всех ключей одинаковая цифра, пропускаются, а гистограммы остальных
+// считаются за один просмотр. Сортировка устойчива, буфер — n элементов.
+// Если нужных проходов больше max_passes, диапазон не меняется и
+// возвращается false
+template <typename T, typename KeyFunction>
+bool radix_sort_by_key(T *first, T *last, KeyFunction key, int max_passes = 64)
+{
+    using Key = decltype(key(*first));
+    static_assert(std::is_unsigned<Key>::value, "radix key must be unsigned");
+
+    constexpr int key_bits = 8 * sizeof(Key);
+    constexpr int digit_bits = key_bits >= 32 ? 11 : 8;
+    constexpr int passes = (key_bits + digit_bits - 1) / digit_bits;
+    constexpr std::size_t radix = std::size_t(1) << digit_bits;
+    constexpr Key mask = Key(radix - 1);
+
+    std::ptrdiff_t n = last - first;
+    if (n < 2)
+        return true;
+
+    // Разряд нужно сортировать, только если в нём отличается хотя бы один ключ
+    Key first_key = key(*first);
+    Key varying = 0;
+    for (T *p = first; p != last; ++p)
+        varying |= key(*p) ^ first_key;
+
+    bool needed[passes];
+    int needed_passes = 0;
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        needed[pass] = ((varying >> (pass * digit_bits)) & mask) != 0;
+        needed_passes += needed[pass];
+    }
+    if (needed_passes > max_passes)
+        return false;
+    if (needed_passes == 0)
+        return true;
+
+    std::vector<std::ptrdiff_t> counts(passes * radix, 0);
+    for (T *p = first; p != last; ++p)
+    {
+        Key k = key(*p);
+        for (int pass = 0; pass < passes; ++pass)
+        {
+            if (needed[pass])
+                ++counts[pass * radix + ((k >> (pass * digit_bits)) & mask)];
+        }
+    }
+
+    std::unique_ptr<T[]> buffer(new T[n]);
+    T *src = first;
+    T *dst = buffer.get();
+
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        if (!needed[pass])
+            continue;
+
+        int shift = pass * digit_bits;
+        std::ptrdiff_t *count = &counts[pass * radix];
+
+        std::ptrdiff_t offset = 0;
+        for (std::size_t digit = 0; digit < radix; ++digit)
+        {
+            std::ptrdiff_t c = count[digit];
+            count[digit] = offset;
+            offset += c;
+        }
+
+        for (T *p = src; p != src + n; ++p)
+            dst[count[(key(*p) >> shift) & mask]++] = std::move(*p);
+
+        std::swap(src, dst);
+    }
+
+    if (src != first)
+        std::move(src, src + n, first);
+    return true;
+}
+
+// Поразрядная сортировка арифметических значений в порядке std::less или
+// std::greater: порядок по убыванию получается инверсией ключа
+template <typename T, typename Compare>
+bool radix_sort(T *first, T *last, Compare, int max_passes = 64)
+{
+    static_assert(use_radix_sort<T, Compare>, "radix_sort needs an arithmetic type and a standard comparator");
+
+    if constexpr (is_descending_compare<T, Compare>::value)
+        return radix_sort_by_key(first, last, [](T value)
+                                 { return decltype(to_radix_key(value))(~to_radix_key(value)); },
+                                 max_passes);
+    else
+        return radix_sort_by_key(first, last, [](T value)
+                                 { return to_radix_key(value); },
+                                 max_passes);
+}
+
+#endif // RADIX_SORT_H
@@ -0,0 +1,268 @@
+#ifndef SAMPLE_SORT_H
+#define SAMPLE_SORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "ParallelSort.h"
+#include "QuickSort.h"
+#include "ThreadPool.h"
+
+// Целевой размер корзины в байтах (порядка L2-кэша) и пределы числа корзин
+constexpr std::size_t SAMPLE_SORT_BUCKET_BYTES = 1 << 18;
+constexpr std::size_t SAMPLE_SORT_MAX_BUCKETS = 1024;
+constexpr std::size_t SAMPLE_SORT_OVERSAMPLING = 16;
+constexpr std::ptrdiff_t SAMPLE_SORT_MIN_SIZE = 1 << 17;
+constexpr std::ptrdiff_t SAMPLE_SORT_CLASSIFY_BLOCK = 1 << 16;
+
+// Разделители в порядке Эйтцингера (неявное дерево поиска: дети узла j —
+// 2j и 2j + 1). Классификация элемента — спуск фиксированной глубины,
+// в котором результат сравнения прибавляется к индексу без ветвлений.
+// В корзину i попадают элементы из (s[i - 1], s[i]].
+// Если среди разделителей есть равные, выборка нашла частые значения:
+// повторы отбрасываются, и у каждого разделителя появляется корзина
+// равных ему элементов. Тогда корзина 2i получает (s[i - 1], s[i]),
+// корзина 2i + 1 — элементы, равные s[i]; её сортировать не нужно
+template <typename T, typename Compare>
+class SplitterTree final
+{
+    std::vector<T> splitters_;
+    std::vector<T> tree_;
+    int log_buckets_;
+    std::size_t buckets_;
+    bool equal_buckets_ = false;
+    Compare comp_;
+
+public:
+    SplitterTree(const std::vector<T> &splitters, int log_buckets, Compare comp)
+        : splitters_(splitters), log_buckets_(log_buckets), buckets_(std::size_t(1) << log_buckets), comp_(comp)
+    {
+        for (std::size_t i = 1; i < splitters_.size(); ++i)
+        {
+            if (!comp_(splitters_[i - 1], splitters_[i]))
+                equal_buckets_ = true;
+        }
+
+        if (equal_buckets_)
+        {
+            std::size_t distinct = 1;
+            for (std::size_t i = 1; i < splitters_.size(); ++i)
+            {
+                if (comp_(splitters_[distinct - 1], splitters_[i]))
+                    splitters_[distinct++] = splitters_[i];
+            }
+
+            // Лишние уровни дерева не нужны; недостающие разделители
+            // дополняются последним, и их корзины остаются пустыми
+            while (log_buckets_ > 1 && (std::size_t(1) << (log_buckets_ - 1)) > distinct)
+                --log_buckets_;
+            buckets_ = std::size_t(1) << log_buckets_;
+            splitters_.resize(distinct);
+            splitters_.resize(buckets_ - 1, splitters_.back());
+        }
+
+        tree_.reserve(buckets_);
+        tree_.push_back(splitters_[0]); // tree_[0] не используется
+        for (std::size_t j = 1; j < buckets_; ++j)
+        {
+            int depth = floor_log2(static_cast<std::ptrdiff_t>(j));
+            std::size_t level_pos = j - (std::size_t(1) << depth);
+            std::size_t rank = (2 * level_pos + 1) * (std::size_t(1) << (log_buckets_ - depth - 1)) - 1;
+            tree_.push_back(splitters_[rank]);
+        }
+    }
+
+    std::size_t bucket_count() const
+    {
+        return equal_buckets_ ? 2 * buckets_ : buckets_;
+    }
+
+    // Корзина равных элементов: уже упорядочена
+    bool is_equal_bucket(std::size_t bucket) const
+    {
+        return equal_buckets_ && bucket % 2 == 1;
+    }
+
+    std::size_t classify(const T &value) const
+    {
+        std::size_t j = 1;
+        for (int level = 0; level < log_buckets_; ++level)
+            j = 2 * j + (comp_(tree_[j], value) ? 1 : 0);
+        std::size_t bucket = j - buckets_;
+
+        if (!equal_buckets_)
+            return bucket;
+        // value <= s[bucket], равенство — обратное сравнение
+        bool equal = bucket < buckets_ - 1 && !comp_(value, splitters_[bucket]);
+        return 2 * bucket + (equal ? 1 : 0);
+    }
+};
+
+// Дерево разделителей для 2^log_buckets корзин по случайной выборке
+// с запасом SAMPLE_SORT_OVERSAMPLING. Выборка берётся генератором
+// xorshift с фиксированным зерном
+template <typename T, typename Compare>
+SplitterTree<T, Compare> sample_splitters(const T *first, const T *last, Compare comp, int log_buckets)
+{
+    std::ptrdiff_t n = last - first;
+    std::size_t buckets = std::size_t(1) << log_buckets;
+
+    std::vector<T> samples;
+    std::size_t sample_size = SAMPLE_SORT_OVERSAMPLING * buckets;
+    samples.reserve(sample_size);
+    std::uint64_t state = 0x9E3779B97F4A7C15ull ^ static_cast<std::uint64_t>(n);
+    for (std::size_t i = 0; i < sample_size; ++i)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        samples.push_back(first[state % static_cast<std::uint64_t>(n)]);
+    }
+    sort(samples.data(), samples.data() + samples.size(), comp);
+
+    std::vector<T> splitters;
+    splitters.reserve(buckets - 1);
+    for (std::size_t i = 1; i < buckets; ++i)
+        splitters.push_back(samples[i * SAMPLE_SORT_OVERSAMPLING]);
+    return SplitterTree<T, Compare>(splitters, log_buckets, comp);
+}
+
+// Буфер раскладки: n мест под T, поделённых на ячейки (блок, корзина).
+// Ячейка заполняется подряд от своего начала, и буфер помнит, сколько
+// элементов в ней создано, поэтому при исключении в перемещении или
+// компараторе деструктор уничтожает ровно созданные элементы
+template <typename T>
+class SampleSortBuffer final
+{
+    std::vector<std::ptrdiff_t> begin_;
+    std::vector<std::ptrdiff_t> end_;
+    // Выделяется последним: если не хватит памяти, освобождать нечего
+    T *data_;
+
+public:
+    SampleSortBuffer(std::ptrdiff_t n, const std::vector<std::ptrdiff_t> &cell_start)
+        : begin_(cell_start), end_(cell_start),
+          data_(static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignof(T)))))
+    {
+    }
+
+    SampleSortBuffer(const SampleSortBuffer &) = delete;
+    SampleSortBuffer &operator=(const SampleSortBuffer &) = delete;
+
+    ~SampleSortBuffer()
+    {
+        for (std::size_t cell = 0; cell < begin_.size(); ++cell)
+            destroy(cell);
+        ::operator delete(data_, std::align_val_t(alignof(T)));
+    }
+
+    // Переносит value в конец ячейки
+    void push(std::size_t cell, T &value)
+    {
+        new (data_ + end_[cell]) T(std::move(value));
+        ++end_[cell];
+    }
+
+    // Переносит содержимое ячейки в out и уничтожает его в буфере.
+    // Возвращает конец записанного
+    T *pop(std::size_t cell, T *out)
+    {
+        for (std::ptrdiff_t i = begin_[cell]; i < end_[cell]; ++i)
+            *out++ = std::move(data_[i]);
+        destroy(cell);
+        return out;
+    }
+
+private:
+    void destroy(std::size_t cell)
+    {
+        for (std::ptrdiff_t i = begin_[cell]; i < end_[cell]; ++i)
+            data_[i].~T();
+        begin_[cell] = end_[cell];
+    }
+};
+
+// Параллельная сортировка выборкой (Super Scalar Sample Sort). По случайной
+// выборке с запасом выбираются разделители, потоки параллельно раскладывают
+// свои блоки по корзинам, считая гистограммы, затем за один проход элементы
+// переносятся в буфер на свои места, и корзины размером порядка кэша
+// сортируются независимо обычным sort(). Частые значения получают корзины
+// равных элементов, поэтому повторы не собираются в одну огромную корзину.
+// Требует n дополнительной памяти
+template <typename T, typename Compare>
+void sample_sort(T *first, T *last, Compare comp, ThreadPool &pool)
+{
+    std::ptrdiff_t n = last - first;
+    if (n < SAMPLE_SORT_MIN_SIZE)
+    {
+        parallel_sort(first, last, comp, pool);
+        return;
+    }
+
+    std::size_t threads = pool.size() + 1;
+    std::size_t range_buckets = 2;
+    int log_buckets = 1;
+    while (range_buckets < SAMPLE_SORT_MAX_BUCKETS &&
+           (range_buckets * SAMPLE_SORT_BUCKET_BYTES < n * sizeof(T) || range_buckets < 4 * threads))
+    {
+        range_buckets *= 2;
+        ++log_buckets;
+    }
+
+    SplitterTree<T, Compare> tree = sample_splitters(first, last, comp, log_buckets);
+    std::size_t buckets = tree.bucket_count();
+
+    std::size_t blocks = static_cast<std::size_t>((n + SAMPLE_SORT_CLASSIFY_BLOCK - 1) / SAMPLE_SORT_CLASSIFY_BLOCK);
+    std::vector<std::uint16_t> bucket_of(n);
+    std::vector<std::ptrdiff_t> counts(blocks * buckets, 0);
+
+    pool.parallel_for(blocks, [&](std::size_t block)
+                      {
+        std::ptrdiff_t begin = block * SAMPLE_SORT_CLASSIFY_BLOCK;
+        std::ptrdiff_t end = begin + SAMPLE_SORT_CLASSIFY_BLOCK < n ? begin + SAMPLE_SORT_CLASSIFY_BLOCK : n;
+        std::ptrdiff_t *histogram = &counts[block * buckets];
+        for (std::ptrdiff_t i = begin; i < end; ++i)
+        {
+            std::size_t b = tree.classify(first[i]);
+            bucket_of[i] = static_cast<std::uint16_t>(b);
+            ++histogram[b];
+        } });
+
+    // Сдвиги: корзина b блока t начинается после всех корзин < b
+    // и после корзины b предыдущих блоков
+    std::vector<std::ptrdiff_t> bucket_start(buckets + 1, 0);
+    std::ptrdiff_t position = 0;
+    for (std::size_t b = 0; b < buckets; ++b)
+    {
+        bucket_start[b] = position;
+        for (std::size_t block = 0; block < blocks; ++block)
+        {
+            std::ptrdiff_t count = counts[block * buckets + b];
+            counts[block * buckets + b] = position;
+            position += count;
+        }
+    }
+    bucket_start[buckets] = n;
+
+    SampleSortBuffer<T> buffer(n, counts);
+
+    pool.parallel_for(blocks, [&](std::size_t block)
+                      {
+        std::ptrdiff_t begin = block * SAMPLE_SORT_CLASSIFY_BLOCK;
+        std::ptrdiff_t end = begin + SAMPLE_SORT_CLASSIFY_BLOCK < n ? begin + SAMPLE_SORT_CLASSIFY_BLOCK : n;
+        for (std::ptrdiff_t i = begin; i < end; ++i)
+            buffer.push(block * buckets + bucket_of[i], first[i]); });
+
+    pool.parallel_for(buckets, [&](std::size_t b)
+                      {
+        T *out = first + bucket_start[b];
+        for (std::size_t block = 0; block < blocks; ++block)
+            out = buffer.pop(block * buckets + b, out);
+        if (!tree.is_equal_bucket(b))
+            sort(first + bucket_start[b], first + bucket_start[b + 1], comp); });
+}
+
+#endif // SAMPLE_SORT_H
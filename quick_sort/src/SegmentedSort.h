@@ -0,0 +1,155 @@
+#ifndef SEGMENTED_SORT_H
+#define SEGMENTED_SORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "QuickSort.h"
+#include "SortingNetwork.h"
+#include "ThreadPool.h"
+
+// Примерное число элементов в одной задаче пула: сегменты раздаются
+// потокам пачками, чтобы накладные расходы задачи окупались
+constexpr std::size_t SEGMENTED_SORT_TASK_ELEMENTS = 1 << 15;
+
+// Элементов в пачке сегментов, группируемых по длине
+constexpr std::size_t SEGMENTED_SORT_BATCH_ELEMENTS = 4096;
+
+// Сегменты типов без сетей сортировки до этой длины сортируются вставками
+// без вызова sort()
+constexpr std::size_t SEGMENTED_SORT_INSERTION_MAX = 16;
+
+// Все сегменты пачки одной длины N: сеть выбирается один раз, а не через
+// косвенный вызов на каждый сегмент
+template <std::size_t N, typename T, typename Offset, typename Compare>
+void segmented_network_batch(T *data, const Offset *offsets, const std::size_t *segments, std::size_t count,
+                             Compare comp)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        sorting_network<N>(data + offsets[segments[i]], comp);
+}
+
+template <typename T, typename Offset, typename Compare, std::size_t... I>
+void segmented_network_dispatch(T *data, const Offset *offsets, const std::size_t *segments, std::size_t count,
+                                std::size_t n, Compare comp, std::index_sequence<I...>)
+{
+    using Batch = void (*)(T *, const Offset *, const std::size_t *, std::size_t, Compare);
+    static constexpr Batch batches[] = {&segmented_network_batch<I + 2, T, Offset, Compare>...};
+    batches[n - 2](data, offsets, segments, count, comp);
+}
+
+// Сегменты [first_segment, last_segment) группируются по классу длины
+// сортировкой подсчётом: короткие — по точной длине для сетей сортировки
+// (или вставками, если сетей для типа нет), длинные — sort()
+template <typename T, typename Offset, typename Compare>
+void segmented_sort_batch(T *data, const Offset *offsets, std::size_t first_segment, std::size_t last_segment,
+                          Compare comp, std::vector<std::size_t> &segments)
+{
+    constexpr bool networks = use_sorting_network<T, Compare>;
+    constexpr std::size_t network_max = networks ? SORTING_NETWORK_MAX_SIZE : 1;
+    constexpr std::size_t insertion_class = network_max + 1;
+    constexpr std::size_t large_class = network_max + 2;
+
+    auto size_class = [offsets](std::size_t segment)
+    {
+        std::size_t size = static_cast<std::size_t>(offsets[segment + 1] - offsets[segment]);
+        if (size <= network_max)
+            return size;
+        return !networks && size <= SEGMENTED_SORT_INSERTION_MAX ? insertion_class : large_class;
+    };
+
+    std::size_t starts[large_class + 2] = {};
+    for (std::size_t s = first_segment; s < last_segment; ++s)
+        ++starts[size_class(s) + 1];
+    for (std::size_t c = 1; c <= large_class + 1; ++c)
+        starts[c] += starts[c - 1];
+
+    segments.resize(last_segment - first_segment);
+    std::size_t positions[large_class + 1];
+    std::copy(starts, starts + large_class + 1, positions);
+    for (std::size_t s = first_segment; s < last_segment; ++s)
+        segments[positions[size_class(s)]++] = s;
+
+    if constexpr (use_sorting_network<T, Compare>)
+    {
+        for (std::size_t n = 2; n <= network_max; ++n)
+        {
+            std::size_t count = starts[n + 1] - starts[n];
+            if (count > 0)
+                segmented_network_dispatch(data, offsets, segments.data() + starts[n], count, n, comp,
+                                           std::make_index_sequence<SORTING_NETWORK_MAX_SIZE - 1>());
+        }
+    }
+
+    for (std::size_t i = starts[insertion_class]; i < starts[insertion_class + 1]; ++i)
+        insertion_sort(data + offsets[segments[i]], data + offsets[segments[i] + 1], comp);
+
+    for (std::size_t i = starts[large_class]; i < starts[large_class + 1]; ++i)
+        sort(data + offsets[segments[i]], data + offsets[segments[i] + 1], comp);
+}
+
+// Сегменты обрабатываются пачками по SEGMENTED_SORT_BATCH_ELEMENTS
+// элементов: пачка остаётся в кэше, пока её сегменты обходятся по классам
+template <typename T, typename Offset, typename Compare>
+void segmented_sort_range(T *data, const Offset *offsets, std::size_t first_segment, std::size_t last_segment,
+                          Compare comp)
+{
+    std::vector<std::size_t> segments;
+    while (first_segment < last_segment)
+    {
+        std::size_t end = first_segment + 1;
+        while (end < last_segment &&
+               static_cast<std::size_t>(offsets[end + 1] - offsets[first_segment]) <= SEGMENTED_SORT_BATCH_ELEMENTS)
+            ++end;
+
+        segmented_sort_batch(data, offsets, first_segment, end, comp, segments);
+        first_segment = end;
+    }
+}
+
+// Сортирует каждый из nsegments сегментов [data + offsets[i], data + offsets[i + 1])
+// независимо. offsets содержит nsegments + 1 неубывающих смещений
+template <typename T, typename Offset, typename Compare>
+void segmented_sort(T *data, const Offset *offsets, std::size_t nsegments, Compare comp)
+{
+    if (nsegments == 0)
+        return;
+
+    segmented_sort_range(data, offsets, 0, nsegments, comp);
+}
+
+// То же задачами пула: сегменты делятся на пачки примерно по
+// SEGMENTED_SORT_TASK_ELEMENTS элементов, каждая пачка — одна задача
+template <typename T, typename Offset, typename Compare>
+void segmented_sort(T *data, const Offset *offsets, std::size_t nsegments, Compare comp, ThreadPool &pool)
+{
+    if (nsegments == 0)
+        return;
+
+    std::size_t total = static_cast<std::size_t>(offsets[nsegments] - offsets[0]);
+    std::size_t tasks = (total + SEGMENTED_SORT_TASK_ELEMENTS - 1) / SEGMENTED_SORT_TASK_ELEMENTS;
+    if (tasks <= 1)
+    {
+        segmented_sort_range(data, offsets, 0, nsegments, comp);
+        return;
+    }
+
+    // Граница пачки — первый сегмент, начинающийся не раньше её доли элементов
+    std::vector<std::size_t> bounds(tasks + 1);
+    for (std::size_t t = 0; t < tasks; ++t)
+    {
+        Offset start = static_cast<Offset>(offsets[0] + t * SEGMENTED_SORT_TASK_ELEMENTS);
+        bounds[t] = static_cast<std::size_t>(std::lower_bound(offsets, offsets + nsegments, start) - offsets);
+    }
+    bounds[tasks] = nsegments;
+
+    pool.parallel_for(tasks, [&](std::size_t t)
+                      {
+                          if (bounds[t] < bounds[t + 1])
+                              segmented_sort_range(data, offsets, bounds[t], bounds[t + 1], comp);
+                      });
+}
+
+#endif // SEGMENTED_SORT_H
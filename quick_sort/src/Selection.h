@@ -0,0 +1,156 @@
+#ifndef SELECTION_H
+#define SELECTION_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "QuickSort.h"
+
+// Для k не больше n / SELECTION_HEAP_RATIO частичная сортировка идёт через
+// кучу из k элементов: она помещается в кэш, а почти все остальные элементы
+// отсеиваются одним сравнением с вершиной
+constexpr std::ptrdiff_t SELECTION_HEAP_RATIO = 1024;
+
+// После вызова [first, middle) — куча по comp (на вершине наибольший) из
+// middle - first наименьших элементов диапазона. O(n log k)
+template <typename T, typename Compare>
+void heap_select(T *first, T *middle, T *last, Compare comp)
+{
+    std::ptrdiff_t size = middle - first;
+
+    for (std::ptrdiff_t i = size / 2 - 1; i >= 0; --i)
+        sift_down(first, size, i, comp);
+
+    for (T *p = middle; p != last; ++p)
+    {
+        if (comp(*p, *first))
+        {
+            swap(*p, *first);
+            sift_down(first, size, 0, comp);
+        }
+    }
+}
+
+// Упорядочивает кучу, построенную sift_down()
+template <typename T, typename Compare>
+void sort_heap(T *first, T *last, Compare comp)
+{
+    for (std::ptrdiff_t end = last - first - 1; end > 0; --end)
+    {
+        swap(first[0], first[end]);
+        sift_down(first, end, 0, comp);
+    }
+}
+
+// Быстрый выбор с защитой introselect: когда бюджет глубины исчерпан,
+// n-й элемент находится через кучу за O(n log k)
+template <typename T, typename Compare>
+void introselect(T *first, T *nth, T *last, Compare comp, int depth_limit)
+{
+    while (last - first > INSERTION_SORT_QUANT)
+    {
+        if (depth_limit == 0)
+        {
+            heap_select(first, nth + 1, last, comp);
+            swap(*first, *nth);
+            return;
+        }
+        --depth_limit;
+
+        T *middle = first + (last - first) / 2;
+        T *pivot = median_of_three(first, middle, last - 1, comp);
+
+        if (many_duplicates(first, middle, last, pivot, comp, true))
+        {
+            std::pair<T *, T *> equal = partition_three_way(first, last, pivot, comp);
+            if (nth < equal.first)
+                last = equal.first;
+            else if (nth >= equal.second)
+                first = equal.second;
+            else
+                return;
+            continue;
+        }
+
+        T *p = partition_auto(first, last, pivot, comp).first;
+        if (nth < p)
+            last = p;
+        else if (nth > p)
+            first = p + 1;
+        else
+            return;
+    }
+
+    small_sort(first, last, comp);
+}
+
+// Переставляет элементы так, что *nth — тот, что стоял бы там после
+// сортировки, слева от него не большие, справа не меньшие. O(n) в среднем
+template <typename T, typename Compare>
+void nth_element(T *first, T *nth, T *last, Compare comp)
+{
+    if (nth == last || last - first < 2)
+        return;
+
+    introselect(first, nth, last, comp, 2 * floor_log2(last - first));
+}
+
+// [first, middle) — отсортированные middle - first наименьших элементов,
+// порядок остальных не определён. Малые k — через кучу за O(n log k),
+// иначе быстрый выбор и сортировка префикса за O(n + k log k)
+template <typename T, typename Compare>
+void partial_sort(T *first, T *middle, T *last, Compare comp)
+{
+    std::ptrdiff_t k = middle - first;
+    if (k <= 0)
+        return;
+
+    if (k <= (last - first) / SELECTION_HEAP_RATIO)
+    {
+        heap_select(first, middle, last, comp);
+        sort_heap(first, middle, comp);
+        return;
+    }
+
+    nth_element(first, middle - 1, last, comp);
+    sort(first, middle - 1, comp);
+}
+
+// k первых в порядке comp элементов диапазона, отсортированные. Вход не
+// меняется, для малых k дополнительная память — O(k)
+template <typename T, typename Compare>
+std::vector<T> top_k(const T *first, const T *last, std::ptrdiff_t k, Compare comp)
+{
+    std::ptrdiff_t n = last - first;
+    if (k > n)
+        k = n;
+    if (k <= 0)
+        return {};
+
+    if (k > n / SELECTION_HEAP_RATIO)
+    {
+        std::vector<T> result(first, last);
+        partial_sort(result.data(), result.data() + k, result.data() + n, comp);
+        result.erase(result.begin() + k, result.end());
+        return result;
+    }
+
+    std::vector<T> heap(first, first + k);
+    for (std::ptrdiff_t i = k / 2 - 1; i >= 0; --i)
+        sift_down(heap.data(), k, i, comp);
+
+    for (const T *p = first + k; p != last; ++p)
+    {
+        if (comp(*p, heap[0]))
+        {
+            heap[0] = *p;
+            sift_down(heap.data(), k, 0, comp);
+        }
+    }
+
+    sort_heap(heap.data(), heap.data() + k, comp);
+    return heap;
+}
+
+#endif // SELECTION_H
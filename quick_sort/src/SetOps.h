@@ -0,0 +1,309 @@
+#ifndef SET_OPS_H
+#define SET_OPS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "CompareTraits.h"
+#include "CpuFeatures.h"
+#include "SimdPartition.h"
+
+// Если один вход длиннее другого хотя бы в SET_OPS_GALLOP_RATIO раз, по
+// длинному идёт экспоненциальный поиск: O(m log(n / m)) вместо O(n + m)
+constexpr std::ptrdiff_t SET_OPS_GALLOP_RATIO = 32;
+
+// Объединение без ветвлений выгодно, пока входы отличаются по длине
+// меньше чем в SET_OPS_BRANCHLESS_RATIO раз: дальше сравнения с ветвлениями
+// почти всегда выбирают длинный вход и хорошо предсказываются
+constexpr std::ptrdiff_t SET_OPS_BRANCHLESS_RATIO = 3;
+
+// Первый элемент [first, last), не идущий раньше value: шаг удваивается,
+// пока элементы меньше value, затем бинарный поиск внутри последнего шага.
+// O(log d), где d — расстояние от first до ответа
+template <typename T, typename U, typename Compare>
+const T *gallop_lower_bound(const T *first, const T *last, const U &value, Compare comp)
+{
+    if (first == last || !comp(*first, value))
+        return first;
+
+    std::ptrdiff_t n = last - first;
+    std::ptrdiff_t bound = 1;
+    while (bound < n && comp(first[bound], value))
+        bound *= 2;
+
+    const T *lo = first + bound / 2 + 1;
+    const T *hi = first + (bound < n ? bound : n);
+    while (lo < hi)
+    {
+        const T *middle = lo + (hi - lo) / 2;
+        if (comp(*middle, value))
+            lo = middle + 1;
+        else
+            hi = middle;
+    }
+    return lo;
+}
+
+// Пересечение без ветвлений: оба указателя сдвигаются по результатам
+// сравнений, а запись в out происходит всегда, но засчитывается только
+// при совпадении
+template <typename T, typename Compare>
+T *intersect_scalar(const T *a, const T *a_last, const T *b, const T *b_last, T *out, Compare comp)
+{
+    while (a != a_last && b != b_last)
+    {
+        bool a_less = comp(*a, *b);
+        bool b_less = comp(*b, *a);
+        *out = *a;
+        out += !a_less && !b_less;
+        a += !b_less;
+        b += !a_less;
+    }
+    return out;
+}
+
+// Каждый элемент короткого входа ищется в длинном от предыдущей находки
+template <typename T, typename Compare>
+T *intersect_gallop(const T *small, const T *small_last, const T *large, const T *large_last, T *out, Compare comp)
+{
+    for (; small != small_last; ++small)
+    {
+        large = gallop_lower_bound(large, large_last, *small, comp);
+        if (large == large_last)
+            break;
+        if (!comp(*small, *large))
+        {
+            *out++ = *small;
+            ++large;
+        }
+    }
+    return out;
+}
+
+// Блочное пересечение реализовано для 32- и 64-битных целых со
+// стандартным компаратором: совпадение — побитовое равенство, поэтому
+// знак не важен, а порядок нужен только для выбора сдвигаемого блока
+template <typename T, typename Compare>
+constexpr bool use_simd_intersect = SORT_HAS_X86_SIMD && std::is_integral<T>::value &&
+                                    (sizeof(T) == 4 || sizeof(T) == 8) && is_standard_compare<T, Compare>::value;
+
+#if SORT_HAS_X86_SIMD
+
+// Маска полос a, равных какой-либо полосе b: b сравнивается с a во всех
+// циклических сдвигах
+template <typename Lane>
+struct Avx2MatchOps;
+
+template <>
+struct Avx2MatchOps<std::int32_t>
+{
+    SORT_TARGET_AVX2 static unsigned match(__m256i a, __m256i b)
+    {
+        const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+        __m256i equal = _mm256_cmpeq_epi32(a, b);
+        for (int i = 1; i < 8; ++i)
+        {
+            b = _mm256_permutevar8x32_epi32(b, rotate);
+            equal = _mm256_or_si256(equal, _mm256_cmpeq_epi32(a, b));
+        }
+        return unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+    }
+};
+
+template <>
+struct Avx2MatchOps<std::int64_t>
+{
+    SORT_TARGET_AVX2 static unsigned match(__m256i a, __m256i b)
+    {
+        __m256i equal = _mm256_cmpeq_epi64(a, b);
+        for (int i = 1; i < 4; ++i)
+        {
+            b = _mm256_permute4x64_epi64(b, 0x39);
+            equal = _mm256_or_si256(equal, _mm256_cmpeq_epi64(a, b));
+        }
+        return unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(equal)));
+    }
+};
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+// Блоки по вектору из a и b сравниваются все со всеми, совпавшие полосы a
+// сжимаются в out; затем сдвигается блок с меньшим последним элементом
+// (оба, если последние равны). Остаток короче вектора — скалярно
+template <typename T, typename Compare>
+SORT_TARGET_AVX2 T *avx2_intersect(const T *a, const T *a_last, const T *b, const T *b_last, T *out, Compare comp)
+{
+    using Lane = simd_lane_t<T>;
+    using Ops = Avx2Ops<Lane>;
+    constexpr std::ptrdiff_t V = Ops::lanes;
+
+    while (a_last - a >= V && b_last - b >= V)
+    {
+        typename Ops::Vector va = Ops::load(a);
+        unsigned mask = Avx2MatchOps<Lane>::match(va, Ops::load(b));
+        if (mask)
+        {
+            int count = __builtin_popcount(mask);
+            Ops::store(out, mask, va, count);
+            out += count;
+        }
+
+        T a_max = a[V - 1];
+        T b_max = b[V - 1];
+        a += V * !comp(b_max, a_max);
+        b += V * !comp(a_max, b_max);
+    }
+
+    return intersect_scalar(a, a_last, b, b_last, out, comp);
+}
+
+#pragma GCC diagnostic pop
+
+#endif
+
+// Пересечение упорядоченных по comp входов без повторов (например, после
+// sort_unique()) в out, где должно быть место для меньшего из входов.
+// Из равных элементов записывается любой. Входы сильно разной длины
+// пересекаются экспоненциальным поиском, близкой — сравнением блоков
+// векторными инструкциями (целые числа, AVX2) или без ветвлений.
+// Возвращает конец записанного
+template <typename T, typename Compare>
+T *intersect_sorted(const T *a, const T *a_last, const T *b, const T *b_last, T *out, Compare comp)
+{
+    std::ptrdiff_t na = a_last - a;
+    std::ptrdiff_t nb = b_last - b;
+
+    if (na / SET_OPS_GALLOP_RATIO >= nb)
+        return intersect_gallop(b, b_last, a, a_last, out, comp);
+    if (nb / SET_OPS_GALLOP_RATIO >= na)
+        return intersect_gallop(a, a_last, b, b_last, out, comp);
+
+#if SORT_HAS_X86_SIMD
+    if constexpr (use_simd_intersect<T, Compare>)
+    {
+        if (cpu_has_avx2())
+            return avx2_intersect(a, a_last, b, b_last, out, comp);
+    }
+#endif
+
+    return intersect_scalar(a, a_last, b, b_last, out, comp);
+}
+
+template <typename T>
+T *copy_range(const T *first, const T *last, T *out)
+{
+    while (first != last)
+        *out++ = *first++;
+    return out;
+}
+
+// Объединение без ветвлений: записывается меньший из текущих элементов,
+// при равенстве сдвигаются оба входа
+template <typename T, typename Compare>
+T *union_scalar(const T *a, const T *a_last, const T *b, const T *b_last, T *out, Compare comp)
+{
+    while (a != a_last && b != b_last)
+    {
+        bool take_a = !comp(*b, *a);
+        bool take_b = !comp(*a, *b);
+        *out++ = take_a ? *a : *b;
+        a += take_a;
+        b += take_b;
+    }
+
+    out = copy_range(a, a_last, out);
+    return copy_range(b, b_last, out);
+}
+
+// Слияние с ветвлениями: при сильно разной длине входов почти все
+// сравнения выбирают длинный вход и хорошо предсказываются
+template <typename T, typename Compare>
+T *union_branchy(const T *a, const T *a_last, const T *b, const T *b_last, T *out, Compare comp)
+{
+    while (a != a_last && b != b_last)
+    {
+        if (comp(*a, *b))
+        {
+            *out++ = *a++;
+        }
+        else if (comp(*b, *a))
+        {
+            *out++ = *b++;
+        }
+        else
+        {
+            *out++ = *a++;
+            ++b;
+        }
+    }
+
+    out = copy_range(a, a_last, out);
+    return copy_range(b, b_last, out);
+}
+
+// Объединение упорядоченных по comp входов без повторов в out, где должно
+// быть место для суммы их длин; каждое значение записывается один раз,
+// из равных элементов — любой. Результат всё равно линеен по длине
+// входов, поэтому экспоненциальный поиск не помогает; входы близкой длины
+// сливаются без ветвлений. Возвращает конец записанного
+template <typename T, typename Compare>
+T *union_sorted(const T *a, const T *a_last, const T *b, const T *b_last, T *out, Compare comp)
+{
+    std::ptrdiff_t na = a_last - a;
+    std::ptrdiff_t nb = b_last - b;
+
+    if (na / SET_OPS_BRANCHLESS_RATIO >= nb || nb / SET_OPS_BRANCHLESS_RATIO >= na)
+        return union_branchy(a, a_last, b, b_last, out, comp);
+    return union_scalar(a, a_last, b, b_last, out, comp);
+}
+
+// Соединение слиянием двух упорядоченных по ключу отношений: emit(l, r)
+// вызывается для каждой пары элементов с равными ключами, группы равных
+// ключей дают все пары. comp сравнивает элементы в обоих порядках,
+// comp(L, R) и comp(R, L). Если одна сторона длиннее другой хотя бы
+// в SET_OPS_GALLOP_RATIO раз, несовпадающие участки пропускаются
+// экспоненциальным поиском. Возвращает число пар
+template <typename L, typename R, typename Compare, typename Emit>
+std::size_t merge_join(const L *l, const L *l_last, const R *r, const R *r_last, Compare comp, Emit emit)
+{
+    std::ptrdiff_t nl = l_last - l;
+    std::ptrdiff_t nr = r_last - r;
+    bool gallop_l = nl / SET_OPS_GALLOP_RATIO >= nr;
+    bool gallop_r = nr / SET_OPS_GALLOP_RATIO >= nl;
+
+    std::size_t pairs = 0;
+    while (l != l_last && r != r_last)
+    {
+        if (comp(*l, *r))
+        {
+            l = gallop_l ? gallop_lower_bound(l, l_last, *r, comp) : l + 1;
+            continue;
+        }
+        if (comp(*r, *l))
+        {
+            r = gallop_r ? gallop_lower_bound(r, r_last, *l, comp) : r + 1;
+            continue;
+        }
+
+        const L *l_end = l + 1;
+        while (l_end != l_last && !comp(*r, *l_end))
+            ++l_end;
+        const R *r_end = r + 1;
+        while (r_end != r_last && !comp(*l, *r_end))
+            ++r_end;
+
+        for (const L *p = l; p != l_end; ++p)
+        {
+            for (const R *q = r; q != r_end; ++q)
+                emit(*p, *q);
+        }
+        pairs += static_cast<std::size_t>(l_end - l) * static_cast<std::size_t>(r_end - r);
+        l = l_end;
+        r = r_end;
+    }
+    return pairs;
+}
+
+#endif // SET_OPS_H
@@ -0,0 +1,420 @@
+#ifndef SIMD_PARTITION_H
+#define SIMD_PARTITION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "CompareTraits.h"
+#include "CpuFeatures.h"
+#include "SortStats.h"
+
+#if SORT_HAS_X86_SIMD
+#include <immintrin.h>
+#endif
+
+enum class SimdLevel
+{
+    none,
+    avx2,
+    avx512
+};
+
+inline SimdLevel detect_simd_level()
+{
+    if (cpu_has_avx512())
+        return SimdLevel::avx512;
+    if (cpu_has_avx2())
+        return SimdLevel::avx2;
+    return SimdLevel::none;
+}
+
+// Векторное разбиение реализовано для 32/64-битных знаковых целых,
+// float и double со стандартными компараторами
+template <typename T>
+constexpr bool is_simd_partition_key = (std::is_integral<T>::value && std::is_signed<T>::value &&
+                                        (sizeof(T) == 4 || sizeof(T) == 8)) ||
+                                       std::is_same<T, float>::value || std::is_same<T, double>::value;
+
+template <typename T, typename Compare>
+constexpr bool use_simd_partition = SORT_HAS_X86_SIMD && is_simd_partition_key<T> &&
+                                    is_standard_compare<T, Compare>::value;
+
+template <typename T>
+using SimdPartitionKernel = T *(*)(T *, T *, T);
+
+#if SORT_HAS_X86_SIMD
+
+// Операции над векторами для конкретного набора инструкций: загрузка,
+// сравнение с маской полос и сжатая запись первых count выбранных полос
+template <typename Lane>
+struct Avx512Ops;
+
+template <>
+struct Avx512Ops<std::int32_t>
+{
+    using Vector = __m512i;
+    using Mask = __mmask16;
+    static constexpr int lanes = 16;
+
+    SORT_TARGET_AVX512 static Vector load(const void *p) { return _mm512_loadu_si512(p); }
+    SORT_TARGET_AVX512 static Vector set1(std::int32_t v) { return _mm512_set1_epi32(v); }
+    SORT_TARGET_AVX512 static Mask less(Vector a, Vector b) { return _mm512_cmplt_epi32_mask(a, b); }
+    SORT_TARGET_AVX512 static void store(void *p, Mask m, Vector v, int count)
+    {
+        _mm512_mask_storeu_epi32(p, Mask((1u << count) - 1), _mm512_maskz_compress_epi32(m, v));
+    }
+};
+
+template <>
+struct Avx512Ops<std::int64_t>
+{
+    using Vector = __m512i;
+    using Mask = __mmask8;
+    static constexpr int lanes = 8;
+
+    SORT_TARGET_AVX512 static Vector load(const void *p) { return _mm512_loadu_si512(p); }
+    SORT_TARGET_AVX512 static Vector set1(std::int64_t v) { return _mm512_set1_epi64(v); }
+    SORT_TARGET_AVX512 static Mask less(Vector a, Vector b) { return _mm512_cmplt_epi64_mask(a, b); }
+    SORT_TARGET_AVX512 static void store(void *p, Mask m, Vector v, int count)
+    {
+        _mm512_mask_storeu_epi64(p, Mask((1u << count) - 1), _mm512_maskz_compress_epi64(m, v));
+    }
+};
+
+template <>
+struct Avx512Ops<float>
+{
+    using Vector = __m512;
+    using Mask = __mmask16;
+    static constexpr int lanes = 16;
+
+    SORT_TARGET_AVX512 static Vector load(const void *p) { return _mm512_loadu_ps(p); }
+    SORT_TARGET_AVX512 static Vector set1(float v) { return _mm512_set1_ps(v); }
+    SORT_TARGET_AVX512 static Mask less(Vector a, Vector b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    SORT_TARGET_AVX512 static void store(void *p, Mask m, Vector v, int count)
+    {
+        _mm512_mask_storeu_ps(p, Mask((1u << count) - 1), _mm512_maskz_compress_ps(m, v));
+    }
+};
+
+template <>
+struct Avx512Ops<double>
+{
+    using Vector = __m512d;
+    using Mask = __mmask8;
+    static constexpr int lanes = 8;
+
+    SORT_TARGET_AVX512 static Vector load(const void *p) { return _mm512_loadu_pd(p); }
+    SORT_TARGET_AVX512 static Vector set1(double v) { return _mm512_set1_pd(v); }
+    SORT_TARGET_AVX512 static Mask less(Vector a, Vector b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+    SORT_TARGET_AVX512 static void store(void *p, Mask m, Vector v, int count)
+    {
+        _mm512_mask_storeu_pd(p, Mask((1u << count) - 1), _mm512_maskz_compress_pd(m, v));
+    }
+};
+
+// В AVX2 нет сжатия, поэтому выбранные полосы собираются перестановкой
+// по таблице, построенной на этапе компиляции: для маски m в начале строки
+// стоят индексы 32-битных слов выбранных полос по порядку
+template <int Lanes>
+struct CompressTable
+{
+    static constexpr int words_per_lane = 8 / Lanes;
+    std::int32_t indices[1 << Lanes][8];
+
+    constexpr CompressTable() : indices()
+    {
+        for (int mask = 0; mask < (1 << Lanes); ++mask)
+        {
+            int out = 0;
+            for (int lane = 0; lane < Lanes; ++lane)
+            {
+                if (mask & (1 << lane))
+                {
+                    for (int word = 0; word < words_per_lane; ++word)
+                        indices[mask][out++] = lane * words_per_lane + word;
+                }
+            }
+            while (out < 8)
+            {
+                indices[mask][out] = out;
+                ++out;
+            }
+        }
+    }
+};
+
+template <int Lanes>
+constexpr CompressTable<Lanes> compress_table{};
+
+SORT_TARGET_AVX2 inline __m256i avx2_compress_indices(int lanes, unsigned mask)
+{
+    const std::int32_t *row = lanes == 8 ? compress_table<8>.indices[mask] : compress_table<4>.indices[mask];
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row));
+}
+
+SORT_TARGET_AVX2 inline __m256i avx2_prefix_mask32(int count)
+{
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(count), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+SORT_TARGET_AVX2 inline __m256i avx2_prefix_mask64(int count)
+{
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x(count), _mm256_setr_epi64x(0, 1, 2, 3));
+}
+
+template <typename Lane>
+struct Avx2Ops;
+
+template <>
+struct Avx2Ops<std::int32_t>
+{
+    using Vector = __m256i;
+    using Mask = unsigned;
+    static constexpr int lanes = 8;
+
+    SORT_TARGET_AVX2 static Vector load(const void *p) { return _mm256_loadu_si256(static_cast<const __m256i *>(p)); }
+    SORT_TARGET_AVX2 static Vector set1(std::int32_t v) { return _mm256_set1_epi32(v); }
+    SORT_TARGET_AVX2 static Mask less(Vector a, Vector b)
+    {
+        return Mask(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(b, a))));
+    }
+    SORT_TARGET_AVX2 static void store(void *p, Mask m, Vector v, int count)
+    {
+        Vector packed = _mm256_permutevar8x32_epi32(v, avx2_compress_indices(lanes, m & 0xFF));
+        _mm256_maskstore_epi32(static_cast<int *>(p), avx2_prefix_mask32(count), packed);
+    }
+};
+
+template <>
+struct Avx2Ops<std::int64_t>
+{
+    using Vector = __m256i;
+    using Mask = unsigned;
+    static constexpr int lanes = 4;
+
+    SORT_TARGET_AVX2 static Vector load(const void *p) { return _mm256_loadu_si256(static_cast<const __m256i *>(p)); }
+    SORT_TARGET_AVX2 static Vector set1(std::int64_t v) { return _mm256_set1_epi64x(v); }
+    SORT_TARGET_AVX2 static Mask less(Vector a, Vector b)
+    {
+        return Mask(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(b, a))));
+    }
+    SORT_TARGET_AVX2 static void store(void *p, Mask m, Vector v, int count)
+    {
+        Vector packed = _mm256_permutevar8x32_epi32(v, avx2_compress_indices(lanes, m & 0xF));
+        _mm256_maskstore_epi64(static_cast<long long *>(p), avx2_prefix_mask64(count), packed);
+    }
+};
+
+template <>
+struct Avx2Ops<float>
+{
+    using Vector = __m256;
+    using Mask = unsigned;
+    static constexpr int lanes = 8;
+
+    SORT_TARGET_AVX2 static Vector load(const void *p) { return _mm256_loadu_ps(static_cast<const float *>(p)); }
+    SORT_TARGET_AVX2 static Vector set1(float v) { return _mm256_set1_ps(v); }
+    SORT_TARGET_AVX2 static Mask less(Vector a, Vector b) { return Mask(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ))); }
+    SORT_TARGET_AVX2 static void store(void *p, Mask m, Vector v, int count)
+    {
+        Vector packed = _mm256_permutevar8x32_ps(v, avx2_compress_indices(lanes, m & 0xFF));
+        _mm256_maskstore_ps(static_cast<float *>(p), avx2_prefix_mask32(count), packed);
+    }
+};
+
+template <>
+struct Avx2Ops<double>
+{
+    using Vector = __m256d;
+    using Mask = unsigned;
+    static constexpr int lanes = 4;
+
+    SORT_TARGET_AVX2 static Vector load(const void *p) { return _mm256_loadu_pd(static_cast<const double *>(p)); }
+    SORT_TARGET_AVX2 static Vector set1(double v) { return _mm256_set1_pd(v); }
+    SORT_TARGET_AVX2 static Mask less(Vector a, Vector b) { return Mask(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ))); }
+    SORT_TARGET_AVX2 static void store(void *p, Mask m, Vector v, int count)
+    {
+        __m256 packed = _mm256_permutevar8x32_ps(_mm256_castpd_ps(v), avx2_compress_indices(lanes, m & 0xF));
+        _mm256_maskstore_pd(static_cast<double *>(p), avx2_prefix_mask64(count), _mm256_castps_pd(packed));
+    }
+};
+
+// Тип полосы вектора для T: long и long long одинаково идут как int64_t
+template <typename T>
+using simd_lane_t = std::conditional_t<std::is_floating_point<T>::value, T,
+                                       std::conditional_t<sizeof(T) == 4, std::int32_t, std::int64_t>>;
+
+// Вспомогательные функции ниже всегда встраиваются в ядра с атрибутом
+// target, поэтому предупреждение о смене ABI для векторных аргументов к ним
+// не относится
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+// Один вектор: полосы, уходящие влево, дописываются за left, остальные —
+// перед right. Записывается ровно lanes элементов
+template <typename Ops, bool Descending, typename T>
+__attribute__((always_inline)) inline void simd_partition_vector(const typename Ops::Vector &v,
+                                                                 const typename Ops::Vector &pivot,
+                                                                 T *&left, T *&right)
+{
+    typename Ops::Mask to_left = Descending ? Ops::less(pivot, v) : Ops::less(v, pivot);
+    int count = __builtin_popcount(unsigned(to_left));
+
+    Ops::store(left, to_left, v, count);
+    left += count;
+    right -= Ops::lanes - count;
+    Ops::store(right, typename Ops::Mask(~to_left), v, Ops::lanes - count);
+}
+
+// Векторное разбиение на месте (Bramas, 2017): крайние векторы сохраняются
+// в регистрах, а затем очередной вектор читается с той стороны, где
+// свободного места меньше, так что запись никогда не затирает непрочитанное.
+// Возвращает границу: слева элементы, идущие раньше pivot. Тело встраивается
+// в функции с атрибутом target, которые и задают набор инструкций
+template <typename Ops, bool Descending, typename T>
+__attribute__((always_inline)) inline T *simd_partition_range(T *first, T *last, T pivot)
+{
+    constexpr int V = Ops::lanes;
+    typename Ops::Vector pv = Ops::set1(static_cast<simd_lane_t<T>>(pivot));
+
+    T *left_w = first, *right_w = last;
+    T *left_r = first + V, *right_r = last - V;
+    typename Ops::Vector saved_left = Ops::load(first);
+    typename Ops::Vector saved_right = Ops::load(last - V);
+
+    while (right_r - left_r >= V)
+    {
+        typename Ops::Vector v;
+        if (left_r - left_w <= right_w - right_r)
+        {
+            v = Ops::load(left_r);
+            left_r += V;
+        }
+        else
+        {
+            right_r -= V;
+            v = Ops::load(right_r);
+        }
+        simd_partition_vector<Ops, Descending>(v, pv, left_w, right_w);
+    }
+
+    // Остаток короче вектора раскладывается скалярно через буфер на стеке
+    T rest[V];
+    std::ptrdiff_t rest_size = right_r - left_r;
+    for (std::ptrdiff_t i = 0; i < rest_size; ++i)
+        rest[i] = left_r[i];
+    for (std::ptrdiff_t i = 0; i < rest_size; ++i)
+    {
+        if (Descending ? pivot < rest[i] : rest[i] < pivot)
+            *left_w++ = rest[i];
+        else
+            *--right_w = rest[i];
+    }
+
+    simd_partition_vector<Ops, Descending>(saved_left, pv, left_w, right_w);
+    simd_partition_vector<Ops, Descending>(saved_right, pv, left_w, right_w);
+    return left_w;
+}
+
+#pragma GCC diagnostic pop
+
+template <typename T, bool Descending>
+SORT_TARGET_AVX512 T *avx512_partition(T *first, T *last, T pivot)
+{
+    return simd_partition_range<Avx512Ops<simd_lane_t<T>>, Descending>(first, last, pivot);
+}
+
+template <typename T, bool Descending>
+SORT_TARGET_AVX2 T *avx2_partition(T *first, T *last, T pivot)
+{
+    return simd_partition_range<Avx2Ops<simd_lane_t<T>>, Descending>(first, last, pivot);
+}
+
+#endif
+
+// Ядро для заданного уровня: разбивает [first, last) вокруг значения pivot
+// и возвращает границу. Требует хотя бы двух векторов элементов
+template <typename T, bool Descending>
+SimdPartitionKernel<T> simd_partition_kernel(SimdLevel level)
+{
+#if SORT_HAS_X86_SIMD
+    if (level == SimdLevel::avx512)
+        return &avx512_partition<T, Descending>;
+    if (level == SimdLevel::avx2)
+        return &avx2_partition<T, Descending>;
+#endif
+    (void)level;
+    return nullptr;
+}
+
+template <typename T, bool Descending>
+SimdPartitionKernel<T> best_simd_partition_kernel()
+{
+    static const SimdPartitionKernel<T> kernel = simd_partition_kernel<T, Descending>(detect_simd_level());
+    return kernel;
+}
+
+template <typename T, typename Compare>
+bool simd_partition_available()
+{
+    if constexpr (use_simd_partition<T, Compare>)
+        return best_simd_partition_kernel<T, is_descending_compare<T, Compare>::value>() != nullptr;
+    else
+        return false;
+}
+
+// Векторное разбиение с контрактом partition_right(): ядро выбирается по
+// возможностям процессора. Сначала, как в pdqsort, пропускаются уже стоящие
+// на местах края, что заодно распознаёт разбитый заранее диапазон
+template <typename T, typename Compare>
+std::pair<T *, bool> simd_partition(T *first, T *last, T *pivot, Compare comp)
+{
+    sort_stats(comp).on_swap();
+    std::swap(*pivot, *first);
+    T value = *first;
+
+    T *l = first + 1;
+    T *r = last;
+
+    while (l < r && comp(*l, value))
+        ++l;
+    while (l < r && !comp(*(r - 1), value))
+        --r;
+
+    bool already_partitioned = l == r;
+
+    SimdPartitionKernel<T> kernel = best_simd_partition_kernel<T, is_descending_compare<T, Compare>::value>();
+    if (!already_partitioned && kernel && r - l >= 2 * 64 / static_cast<std::ptrdiff_t>(sizeof(T)))
+    {
+        sort_stats(comp).on_move(static_cast<std::uint64_t>(r - l));
+        l = kernel(l, r, value);
+    }
+    else
+    {
+        while (true)
+        {
+            while (l < r && comp(*l, value))
+                ++l;
+            while (l < r && !comp(*(r - 1), value))
+                --r;
+            if (l == r)
+                break;
+
+            sort_stats(comp).on_swap();
+            std::swap(*l, *(r - 1));
+            ++l;
+            --r;
+        }
+    }
+
+    T *pos = l - 1;
+    *first = *pos;
+    *pos = value;
+    sort_stats(comp).on_move(3);
+    return {pos, already_partitioned};
+}
+
+#endif // SIMD_PARTITION_H
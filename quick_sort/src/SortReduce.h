@@ -0,0 +1,142 @@
+#ifndef SORT_REDUCE_H
+#define SORT_REDUCE_H
+
+#include <cstddef>
+#include <utility>
+
+#include "QuickSort.h"
+
+// Объединение для sort_unique(): из группы равных остаётся один элемент,
+// остальные отбрасываются
+struct KeepFirst
+{
+    template <typename T>
+    void operator()(T &, T &&) const
+    {
+    }
+};
+
+// Упорядоченный диапазон сворачивается на месте: каждая группа равных
+// элементов объединяется в первый из них через combine(первый, std::move(x)).
+// Возвращает новый конец
+template <typename T, typename Compare, typename Combine>
+T *reduce_sorted(T *first, T *last, Compare comp, Combine &combine)
+{
+    if (first == last)
+        return last;
+
+    T *out = first;
+    for (T *p = first + 1; p != last; ++p)
+    {
+        if (!comp(*out, *p))
+            combine(*out, std::move(*p));
+        else if (++out != p)
+            *out = std::move(*p);
+    }
+    return out + 1;
+}
+
+// Переносит [first, last) в позицию out (out <= first), возвращает конец
+template <typename T>
+T *move_down(T *first, T *last, T *out)
+{
+    if (out == first)
+        return last;
+
+    for (; first != last; ++first, ++out)
+        *out = std::move(*first);
+    return out;
+}
+
+// Интроспективная сортировка со свёрткой равных элементов. Каждая часть
+// сортируется и сворачивается рекурсивно, затем выжившие элементы правой
+// части переносятся вплотную к левой. Трёхпутевое разбиение сворачивает
+// всю группу равных опорному сразу, и она больше не участвует в рекурсии:
+// при k различных значениях работа O(n log k). Небольшие диапазоны
+// сворачиваются одним проходом сразу после сортировки, пока они в кэше.
+// Правая часть обрабатывается первой: её предшественник (опорный элемент)
+// нужен many_duplicates() и перемещается только после рекурсии.
+// Глубина ограничена depth_limit, поэтому рекурсия по обеим частям безопасна
+template <typename T, typename Compare, typename Combine, typename Traits = SortTraits<T, Compare>>
+T *reduce_loop(T *first, T *last, Compare comp, Combine &combine, int depth_limit, bool leftmost)
+{
+    if (last - first <= Traits::insertion_sort_quant)
+    {
+        small_sort<T, Compare, Traits>(first, last, comp);
+        return reduce_sorted(first, last, comp, combine);
+    }
+
+    if (depth_limit == 0)
+    {
+        heap_sort(first, last, comp);
+        return reduce_sorted(first, last, comp, combine);
+    }
+    --depth_limit;
+
+    T *middle = first + (last - first) / 2;
+    T *pivot = choose_pivot<Traits>(first, last, comp);
+
+    if (many_duplicates(first, middle, last, pivot, comp, leftmost))
+    {
+        std::pair<T *, T *> equal = partition_three_way(first, last, pivot, comp);
+
+        T *right_end = reduce_loop<T, Compare, Combine, Traits>(equal.second, last, comp, combine, depth_limit, false);
+        T *out = reduce_loop<T, Compare, Combine, Traits>(first, equal.first, comp, combine, depth_limit, leftmost);
+
+        for (T *p = equal.first + 1; p != equal.second; ++p)
+            combine(*equal.first, std::move(*p));
+        if (out != equal.first)
+            *out = std::move(*equal.first);
+
+        return move_down(equal.second, right_end, out + 1);
+    }
+
+    // Слева строго меньшие опорного, справа не меньшие: равный опорному
+    // может оказаться только первым выжившим элементом правой части
+    T *p = partition_with<Traits>(first, last, pivot, comp).first;
+
+    T *right = p + 1;
+    T *right_end = reduce_loop<T, Compare, Combine, Traits>(right, last, comp, combine, depth_limit, false);
+    T *out = reduce_loop<T, Compare, Combine, Traits>(first, p, comp, combine, depth_limit, leftmost);
+
+    if (right != right_end && !comp(*p, *right))
+        combine(*p, std::move(*right++));
+    if (out != p)
+        *out = std::move(*p);
+
+    return move_down(right, right_end, out + 1);
+}
+
+// Сортирует [first, last) и сворачивает каждую группу равных по comp
+// элементов в один: combine(T &acc, T &&x) добавляет x к acc. Порядок
+// объединения внутри группы не определён, поэтому combine должна быть
+// ассоциативной и коммутативной. Возвращает новый конец; элементы за
+// ним находятся в допустимом, но неопределённом состоянии
+template <typename T, typename Compare, typename Combine>
+T *sort_reduce(T *first, T *last, Compare comp, Combine combine)
+{
+    if (last - first < 2)
+        return last;
+
+    // Строки и крупные записи sort() упорядочивает не перемещая элементы
+    // до самого конца, поэтому для них свёртка — отдельный проход
+    if constexpr (use_string_sort<T, Compare> || use_indirect_sort<T>)
+    {
+        sort(first, last, comp);
+        return reduce_sorted(first, last, comp, combine);
+    }
+    else
+    {
+        return reduce_loop(first, last, comp, combine, 2 * floor_log2(last - first), true);
+    }
+}
+
+// Сортирует [first, last) и оставляет по одному элементу из каждой группы
+// равных по comp. Возвращает новый конец, как std::unique()
+template <typename T, typename Compare>
+T *sort_unique(T *first, T *last, Compare comp)
+{
+    return sort_reduce(first, last, comp, KeepFirst());
+}
+
+#endif // SORT_REDUCE_H
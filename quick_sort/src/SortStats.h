@@ -0,0 +1,147 @@
+#ifndef SORT_STATS_H
+#define SORT_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "CompareTraits.h"
+#include "SortTraits.h"
+
+// Счётчики одного вызова quicksort(): заполняются, если компаратор обёрнут
+// в InstrumentedCompare. Сравнения считаются по вызовам компаратора, поэтому
+// векторное разбиение, не вызывающее его, в comparisons не попадает
+struct SortStats
+{
+    // Гистограмма баланса разбиений: корзина i — меньшая часть заняла
+    // от i / 16 до (i + 1) / 16 диапазона. Доля корзины 0 — признак
+    // патологического входа
+    static constexpr int BALANCE_BUCKETS = 8;
+
+    std::uint64_t comparisons = 0;
+    std::uint64_t swaps = 0;
+    // Перемещения элементов помимо обменов: сдвиги вставками, перенос
+    // опорного элемента, запись векторного разбиения
+    std::uint64_t moves = 0;
+    std::uint64_t partitions = 0;
+    std::uint64_t three_way_partitions = 0;
+    std::uint64_t balance[BALANCE_BUCKETS] = {};
+    // Сколько раз сработал базовый случай (сортировка вставками или сеть)
+    std::uint64_t insertion_sorts = 0;
+    std::uint64_t heap_sort_fallbacks = 0;
+    // Наибольшая вложенность разбиений
+    int max_depth = 0;
+
+    void on_compare()
+    {
+        ++comparisons;
+    }
+
+    void on_swap(std::uint64_t count = 1)
+    {
+        swaps += count;
+    }
+
+    void on_move(std::uint64_t count = 1)
+    {
+        moves += count;
+    }
+
+    // Глубина разбиения — сколько уровней бюджета depth_limit израсходовано
+    // от начального значения, заданного в on_start()
+    void on_start(int depth_limit)
+    {
+        depth_budget_ = depth_limit;
+    }
+
+    void on_partition(int depth_limit, std::ptrdiff_t size, std::ptrdiff_t left, std::ptrdiff_t right)
+    {
+        ++partitions;
+
+        std::ptrdiff_t smaller = left < right ? left : right;
+        std::ptrdiff_t bucket = size > 0 ? smaller * 2 * BALANCE_BUCKETS / size : 0;
+        ++balance[bucket < BALANCE_BUCKETS ? bucket : BALANCE_BUCKETS - 1];
+
+        int depth = depth_budget_ - depth_limit;
+        if (depth > max_depth)
+            max_depth = depth;
+    }
+
+    void on_three_way_partition(int depth_limit, std::ptrdiff_t size, std::ptrdiff_t left, std::ptrdiff_t right)
+    {
+        ++three_way_partitions;
+        on_partition(depth_limit, size, left, right);
+    }
+
+    void on_insertion_sort()
+    {
+        ++insertion_sorts;
+    }
+
+    void on_heap_sort()
+    {
+        ++heap_sort_fallbacks;
+    }
+
+private:
+    int depth_budget_ = 0;
+};
+
+// Политика без инструментирования: пустые функции исчезают при встраивании
+struct NoSortStats
+{
+    void on_compare() const {}
+    void on_swap(std::uint64_t = 1) const {}
+    void on_move(std::uint64_t = 1) const {}
+    void on_start(int) const {}
+    void on_partition(int, std::ptrdiff_t, std::ptrdiff_t, std::ptrdiff_t) const {}
+    void on_three_way_partition(int, std::ptrdiff_t, std::ptrdiff_t, std::ptrdiff_t) const {}
+    void on_insertion_sort() const {}
+    void on_heap_sort() const {}
+};
+
+// Компаратор, несущий политику инструментирования: считает свои вызовы,
+// а алгоритмы сортировки находят через него счётчики (sort_stats())
+template <typename Compare>
+struct InstrumentedCompare
+{
+    Compare comp;
+    SortStats *stats;
+
+    template <typename A, typename B>
+    bool operator()(const A &a, const B &b) const
+    {
+        stats->on_compare();
+        return comp(a, b);
+    }
+};
+
+template <typename Compare>
+NoSortStats sort_stats(const Compare &)
+{
+    return NoSortStats();
+}
+
+template <typename Compare>
+SortStats &sort_stats(const InstrumentedCompare<Compare> &comp)
+{
+    return *comp.stats;
+}
+
+// Обёрнутый компаратор выбирает те же алгоритмы и настройки, что исходный,
+// иначе статистика описывала бы другой путь сортировки
+template <typename T, typename Compare>
+struct is_standard_compare<T, InstrumentedCompare<Compare>> : is_standard_compare<T, Compare>
+{
+};
+
+template <typename T, typename Compare>
+struct is_descending_compare<T, InstrumentedCompare<Compare>> : is_descending_compare<T, Compare>
+{
+};
+
+template <typename T, typename Compare>
+struct SortTraits<T, InstrumentedCompare<Compare>> : SortTraits<T, Compare>
+{
+};
+
+#endif // SORT_STATS_H
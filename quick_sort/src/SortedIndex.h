@@ -0,0 +1,325 @@
+#ifndef SORTED_INDEX_H
+#define SORTED_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include "CompareTraits.h"
+#include "CpuFeatures.h"
+#include "SimdPartition.h"
+
+// Узел индекса занимает одну строку кэша
+constexpr std::size_t SORTED_INDEX_NODE_BYTES = 64;
+
+// Запросов, которые пакетный поиск ведёт одновременно: пока ищется один,
+// узлы следующего уровня для остальных уже подгружаются
+constexpr std::size_t SORTED_INDEX_BATCH = 16;
+
+template <typename T>
+struct alignas(SORTED_INDEX_NODE_BYTES) SortedIndexNode
+{
+    static constexpr std::size_t size = sizeof(T) * 2 <= SORTED_INDEX_NODE_BYTES ? SORTED_INDEX_NODE_BYTES / sizeof(T) : 2;
+
+    T keys[size];
+};
+
+// Ранг ключа в узле — число ключей, идущих раньше key. Без ветвлений:
+// сравнения узла независимы и не зависят от предсказателя переходов
+template <typename T, typename Compare>
+struct ScalarNodeRank
+{
+    __attribute__((always_inline)) static std::size_t rank(const T *keys, const T &key, const Compare &comp)
+    {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < SortedIndexNode<T>::size; ++i)
+            count += comp(keys[i], key);
+        return count;
+    }
+};
+
+// Векторный поиск в узле реализован для тех же типов, что и векторное разбиение
+template <typename T, typename Compare>
+constexpr bool use_simd_node_rank = use_simd_partition<T, Compare> &&
+                                    SortedIndexNode<T>::size * sizeof(T) == SORTED_INDEX_NODE_BYTES;
+
+#if SORT_HAS_X86_SIMD
+
+// Сравнение двух векторов AVX2 как маска полос a < b
+template <typename Lane>
+struct Avx2NodeOps;
+
+template <>
+struct Avx2NodeOps<std::int32_t>
+{
+    using Vector = __m256i;
+    static constexpr std::size_t lanes = 8;
+
+    SORT_TARGET_AVX2 static Vector load(const std::int32_t *p) { return _mm256_load_si256(reinterpret_cast<const __m256i *>(p)); }
+    SORT_TARGET_AVX2 static Vector set1(std::int32_t v) { return _mm256_set1_epi32(v); }
+    SORT_TARGET_AVX2 static unsigned less(Vector a, Vector b) { return unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(b, a)))); }
+};
+
+template <>
+struct Avx2NodeOps<std::int64_t>
+{
+    using Vector = __m256i;
+    static constexpr std::size_t lanes = 4;
+
+    SORT_TARGET_AVX2 static Vector load(const std::int64_t *p) { return _mm256_load_si256(reinterpret_cast<const __m256i *>(p)); }
+    SORT_TARGET_AVX2 static Vector set1(std::int64_t v) { return _mm256_set1_epi64x(v); }
+    SORT_TARGET_AVX2 static unsigned less(Vector a, Vector b) { return unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(b, a)))); }
+};
+
+template <>
+struct Avx2NodeOps<float>
+{
+    using Vector = __m256;
+    static constexpr std::size_t lanes = 8;
+
+    SORT_TARGET_AVX2 static Vector load(const float *p) { return _mm256_load_ps(p); }
+    SORT_TARGET_AVX2 static Vector set1(float v) { return _mm256_set1_ps(v); }
+    SORT_TARGET_AVX2 static unsigned less(Vector a, Vector b) { return unsigned(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ))); }
+};
+
+template <>
+struct Avx2NodeOps<double>
+{
+    using Vector = __m256d;
+    static constexpr std::size_t lanes = 4;
+
+    SORT_TARGET_AVX2 static Vector load(const double *p) { return _mm256_load_pd(p); }
+    SORT_TARGET_AVX2 static Vector set1(double v) { return _mm256_set1_pd(v); }
+    SORT_TARGET_AVX2 static unsigned less(Vector a, Vector b) { return unsigned(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ))); }
+};
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+// Узел из двух векторов: маски сравнений с ключом складываются popcount
+template <typename T, typename Compare>
+struct Avx2NodeRank
+{
+    using Lane = simd_lane_t<T>;
+    using Ops = Avx2NodeOps<Lane>;
+
+    SORT_TARGET_AVX2 static std::size_t rank(const T *keys, const T &key, const Compare &)
+    {
+        const Lane *lanes = reinterpret_cast<const Lane *>(keys);
+        typename Ops::Vector k = Ops::set1(static_cast<Lane>(key));
+
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < SortedIndexNode<T>::size; i += Ops::lanes)
+        {
+            typename Ops::Vector v = Ops::load(lanes + i);
+            unsigned mask = is_descending_compare<T, Compare>::value ? Ops::less(k, v) : Ops::less(v, k);
+            count += static_cast<std::size_t>(__builtin_popcount(mask));
+        }
+        return count;
+    }
+};
+
+#pragma GCC diagnostic pop
+
+#endif
+
+// Статическое B+-дерево (S+-дерево) над отсортированным диапазоном для
+// многократного поиска lower_bound. Нижний слой — копия диапазона по
+// SortedIndexNode<T>::size ключей в узле, каждый внутренний узел хранит
+// минимумы своих поддеревьев со второго по последнее и имеет на одного
+// потомка больше, чем ключей. Узел занимает строку кэша, поэтому поиск
+// читает одну строку на уровень, а не на каждое сравнение, как бинарный
+// поиск; спуск выбирает потомка по рангу ключа в узле без ветвлений.
+// Для чисел со стандартным компаратором ранг считается векторно (AVX2)
+template <typename T, typename Compare = std::less<T>>
+class SortedIndex final
+{
+    using Node = SortedIndexNode<T>;
+    static constexpr std::size_t B = Node::size;
+
+    std::vector<Node> nodes_;
+    // Номер первого узла каждого слоя; слой 0 — нижний
+    std::vector<std::size_t> layers_;
+    std::size_t size_ = 0;
+    Compare comp_;
+    bool simd_ = false;
+
+public:
+    // [first, last) должен быть упорядочен по comp, например вызовом
+    // sort() с тем же компаратором
+    SortedIndex(const T *first, const T *last, Compare comp = Compare()) : size_(static_cast<std::size_t>(last - first)), comp_(comp)
+    {
+        for (const T *p = first; p + 1 < last; ++p)
+        {
+            if (comp_(*(p + 1), *p))
+                throw std::invalid_argument("SortedIndex: range is not sorted");
+        }
+
+#if SORT_HAS_X86_SIMD
+        if constexpr (use_simd_node_rank<T, Compare>)
+            simd_ = cpu_has_avx2();
+#endif
+
+        if (size_ == 0)
+            return;
+
+        std::vector<std::size_t> counts;
+        for (std::size_t blocks = (size_ + B - 1) / B;; blocks = (blocks + B) / (B + 1))
+        {
+            layers_.push_back(counts.empty() ? 0 : layers_.back() + counts.back());
+            counts.push_back(blocks);
+            if (blocks == 1)
+                break;
+        }
+        nodes_.resize(layers_.back() + 1);
+
+        // Недостающие ключи заполняются наибольшим: поиск ключей больше
+        // наибольшего завершается до спуска, а остальные их не считают
+        const T &largest = *(last - 1);
+        for (std::size_t i = 0; i < counts[0] * B; ++i)
+            nodes_[i / B].keys[i % B] = i < size_ ? first[i] : largest;
+
+        for (std::size_t h = 1; h < layers_.size(); ++h)
+        {
+            for (std::size_t k = 0; k < counts[h]; ++k)
+            {
+                for (std::size_t j = 0; j < B; ++j)
+                {
+                    // Минимум поддерева — первый ключ его самого левого листа
+                    std::size_t child = k * (B + 1) + j + 1;
+                    if (child >= counts[h - 1])
+                    {
+                        nodes_[layers_[h] + k].keys[j] = largest;
+                        continue;
+                    }
+                    for (std::size_t level = h - 1; level > 0; --level)
+                        child *= B + 1;
+                    nodes_[layers_[h] + k].keys[j] = first[child * B];
+                }
+            }
+        }
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    // Ранг первого элемента, не идущего раньше key (как у std::lower_bound),
+    // или size(), если такого нет
+    std::size_t lower_bound(const T &key) const
+    {
+#if SORT_HAS_X86_SIMD
+        if constexpr (use_simd_node_rank<T, Compare>)
+        {
+            if (simd_)
+                return lower_bound_avx2(key);
+        }
+#endif
+        return search<ScalarNodeRank<T, Compare>>(key);
+    }
+
+    bool contains(const T &key) const
+    {
+        std::size_t rank = lower_bound(key);
+        return rank < size_ && !comp_(key, (*this)[rank]);
+    }
+
+    // Элемент исходного диапазона с рангом rank
+    const T &operator[](std::size_t rank) const
+    {
+        return nodes_[rank / B].keys[rank % B];
+    }
+
+    // lower_bound() для count ключей сразу: запросы идут пачками по
+    // SORTED_INDEX_BATCH, и узел следующего уровня каждого запроса
+    // подгружается, пока обрабатываются остальные. Промахи кэша разных
+    // запросов перекрываются, поэтому на больших индексах это в несколько
+    // раз быстрее поочерёдного поиска
+    void lower_bound(const T *keys, std::size_t count, std::size_t *ranks) const
+    {
+#if SORT_HAS_X86_SIMD
+        if constexpr (use_simd_node_rank<T, Compare>)
+        {
+            if (simd_)
+            {
+                lower_bound_batch_avx2(keys, count, ranks);
+                return;
+            }
+        }
+#endif
+        search_batch<ScalarNodeRank<T, Compare>>(keys, count, ranks);
+    }
+
+private:
+    template <typename Rank>
+    __attribute__((always_inline)) std::size_t search(const T &key) const
+    {
+        if (size_ == 0 || comp_(nodes_[(size_ - 1) / B].keys[(size_ - 1) % B], key))
+            return size_;
+
+        std::size_t k = 0;
+        for (std::size_t h = layers_.size() - 1; h > 0; --h)
+            k = k * (B + 1) + Rank::rank(nodes_[layers_[h] + k].keys, key, comp_);
+        return k * B + Rank::rank(nodes_[k].keys, key, comp_);
+    }
+
+    template <typename Rank>
+    __attribute__((always_inline)) void search_batch(const T *keys, std::size_t count, std::size_t *ranks) const
+    {
+        if (size_ == 0)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                ranks[i] = 0;
+            return;
+        }
+
+        // Ключи больше наибольшего спускаются как наибольший, чтобы не
+        // уйти в несуществующих потомков, а их ранг — size()
+        const T &largest = (*this)[size_ - 1];
+        const T *probe[SORTED_INDEX_BATCH];
+        std::size_t k[SORTED_INDEX_BATCH];
+
+        for (std::size_t start = 0; start < count; start += SORTED_INDEX_BATCH)
+        {
+            std::size_t batch = count - start < SORTED_INDEX_BATCH ? count - start : SORTED_INDEX_BATCH;
+
+            for (std::size_t i = 0; i < batch; ++i)
+            {
+                probe[i] = comp_(largest, keys[start + i]) ? &largest : keys + start + i;
+                k[i] = 0;
+            }
+
+            for (std::size_t h = layers_.size() - 1; h > 0; --h)
+            {
+                for (std::size_t i = 0; i < batch; ++i)
+                {
+                    k[i] = k[i] * (B + 1) + Rank::rank(nodes_[layers_[h] + k[i]].keys, *probe[i], comp_);
+                    __builtin_prefetch(&nodes_[layers_[h - 1] + k[i]]);
+                }
+            }
+
+            for (std::size_t i = 0; i < batch; ++i)
+            {
+                std::size_t rank = k[i] * B + Rank::rank(nodes_[k[i]].keys, *probe[i], comp_);
+                ranks[start + i] = probe[i] == &largest ? size_ : rank;
+            }
+        }
+    }
+
+#if SORT_HAS_X86_SIMD
+    SORT_TARGET_AVX2 std::size_t lower_bound_avx2(const T &key) const
+    {
+        return search<Avx2NodeRank<T, Compare>>(key);
+    }
+
+    SORT_TARGET_AVX2 void lower_bound_batch_avx2(const T *keys, std::size_t count, std::size_t *ranks) const
+    {
+        search_batch<Avx2NodeRank<T, Compare>>(keys, count, ranks);
+    }
+#endif
+};
+
+#endif // SORTED_INDEX_H
@@ -0,0 +1,236 @@
+#ifndef SORTING_NETWORK_H
+#define SORTING_NETWORK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "CompareTraits.h"
+
+constexpr std::size_t SORTING_NETWORK_MAX_SIZE = 16;
+
+// Сети сортировки применяются к целым типам, float и double со стандартными
+// компараторами: для них сравнение-обмен выполняется без ветвлений
+template <typename T, typename Compare>
+constexpr bool use_sorting_network = (std::is_integral<T>::value || std::is_same<T, float>::value ||
+                                      std::is_same<T, double>::value) &&
+                                     is_standard_compare<T, Compare>::value;
+
+struct NetworkComparator
+{
+    unsigned char i;
+    unsigned char j;
+};
+
+// Сети с наименьшим известным числом компараторов (Knuth, TAOCP 5.3.4;
+// Green для 16 элементов). Сети на 13–15 элементов получены из сети на 16
+// отбрасыванием проводов с заведомо наибольшими значениями
+template <std::size_t N>
+struct SortingNetwork;
+
+template <>
+struct SortingNetwork<2>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {0, 1}};
+};
+
+template <>
+struct SortingNetwork<3>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {0, 2}, {0, 1}, {1, 2}};
+};
+
+template <>
+struct SortingNetwork<4>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {0, 2}, {1, 3}, {0, 1}, {2, 3}, {1, 2}};
+};
+
+template <>
+struct SortingNetwork<5>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {0, 3}, {1, 4}, {0, 2}, {1, 3}, {0, 1}, {2, 4}, {1, 2}, {3, 4}, {2, 3}};
+};
+
+template <>
+struct SortingNetwork<6>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {0, 5}, {1, 3}, {2, 4}, {1, 2}, {3, 4}, {0, 3}, {2, 5}, {0, 1}, {2, 3}, {4, 5}, {1, 2},
+        {3, 4}};
+};
+
+template <>
+struct SortingNetwork<7>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {0, 6}, {2, 3}, {4, 5}, {0, 2}, {1, 4}, {3, 6}, {0, 1}, {2, 5}, {3, 4}, {1, 2}, {4, 6},
+        {2, 3}, {4, 5}, {1, 2}, {3, 4}, {5, 6}};
+};
+
+template <>
+struct SortingNetwork<8>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7}, {0, 1}, {2, 3}, {4, 5},
+        {6, 7}, {2, 4}, {3, 5}, {1, 4}, {3, 6}, {1, 2}, {3, 4}, {5, 6}};
+};
+
+template <>
+struct SortingNetwork<9>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {0, 3}, {1, 7}, {2, 5}, {4, 8}, {0, 7}, {2, 4}, {3, 8}, {5, 6}, {0, 2}, {1, 3}, {4, 5},
+        {7, 8}, {1, 4}, {3, 6}, {5, 7}, {0, 1}, {2, 4}, {3, 5}, {6, 8}, {2, 3}, {4, 5}, {6, 7},
+        {1, 2}, {3, 4}, {5, 6}};
+};
+
+template <>
+struct SortingNetwork<10>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {0, 8}, {1, 9}, {2, 7}, {3, 5}, {4, 6}, {0, 2}, {1, 4}, {5, 8}, {7, 9}, {0, 3}, {2, 4},
+        {5, 7}, {6, 9}, {0, 1}, {3, 6}, {8, 9}, {1, 5}, {2, 3}, {4, 8}, {6, 7}, {1, 2}, {3, 5},
+        {4, 6}, {7, 8}, {2, 3}, {4, 5}, {6, 7}, {3, 4}, {5, 6}};
+};
+
+template <>
+struct SortingNetwork<11>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {0, 9}, {1, 6}, {2, 4}, {3, 7}, {5, 8}, {0, 1}, {3, 5}, {4, 10}, {6, 9}, {7, 8}, {1, 3},
+        {2, 5}, {4, 7}, {8, 10}, {0, 4}, {1, 2}, {3, 7}, {5, 9}, {6, 8}, {0, 1}, {2, 6}, {4, 5},
+        {7, 8}, {9, 10}, {2, 4}, {3, 6}, {5, 7}, {8, 9}, {1, 2}, {3, 4}, {5, 6}, {7, 8}, {2, 3},
+        {4, 5}, {6, 7}};
+};
+
+template <>
+struct SortingNetwork<12>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {0, 8}, {1, 7}, {2, 6}, {3, 11}, {4, 10}, {5, 9}, {0, 1}, {2, 5}, {3, 4}, {6, 9}, {7, 8},
+        {10, 11}, {0, 2}, {1, 6}, {5, 10}, {9, 11}, {0, 3}, {1, 2}, {4, 6}, {5, 7}, {8, 11},
+        {9, 10}, {1, 4}, {3, 5}, {6, 8}, {7, 10}, {1, 3}, {2, 5}, {6, 9}, {8, 10}, {2, 3}, {4, 5},
+        {6, 7}, {8, 9}, {4, 6}, {5, 7}, {3, 4}, {5, 6}, {7, 8}};
+};
+
+template <>
+struct SortingNetwork<13>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {1, 12}, {4, 8}, {5, 6}, {7, 11}, {9, 10}, {0, 5}, {1, 7}, {2, 9}, {3, 4}, {11, 12},
+        {0, 1}, {2, 3}, {4, 5}, {6, 8}, {7, 9}, {10, 11}, {0, 2}, {1, 3}, {4, 10}, {5, 11}, {6, 7},
+        {8, 9}, {1, 2}, {3, 12}, {4, 6}, {5, 7}, {8, 10}, {9, 11}, {1, 4}, {2, 6}, {5, 8}, {7, 10},
+        {2, 4}, {3, 6}, {9, 12}, {3, 5}, {6, 8}, {7, 9}, {10, 12}, {3, 4}, {5, 6}, {7, 8}, {9, 10},
+        {11, 12}, {6, 7}, {8, 9}};
+};
+
+template <>
+struct SortingNetwork<14>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {0, 13}, {1, 12}, {4, 8}, {5, 6}, {7, 11}, {9, 10}, {0, 5}, {1, 7}, {2, 9}, {3, 4},
+        {6, 13}, {11, 12}, {0, 1}, {2, 3}, {4, 5}, {6, 8}, {7, 9}, {10, 11}, {12, 13}, {0, 2},
+        {1, 3}, {4, 10}, {5, 11}, {6, 7}, {8, 9}, {1, 2}, {3, 12}, {4, 6}, {5, 7}, {8, 10},
+        {9, 11}, {1, 4}, {2, 6}, {5, 8}, {7, 10}, {9, 13}, {2, 4}, {3, 6}, {9, 12}, {11, 13},
+        {3, 5}, {6, 8}, {7, 9}, {10, 12}, {3, 4}, {5, 6}, {7, 8}, {9, 10}, {11, 12}, {6, 7},
+        {8, 9}};
+};
+
+template <>
+struct SortingNetwork<15>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {0, 13}, {1, 12}, {3, 14}, {4, 8}, {5, 6}, {7, 11}, {9, 10}, {0, 5}, {1, 7}, {2, 9},
+        {3, 4}, {6, 13}, {8, 14}, {11, 12}, {0, 1}, {2, 3}, {4, 5}, {6, 8}, {7, 9}, {10, 11},
+        {12, 13}, {0, 2}, {1, 3}, {4, 10}, {5, 11}, {6, 7}, {8, 9}, {12, 14}, {1, 2}, {3, 12},
+        {4, 6}, {5, 7}, {8, 10}, {9, 11}, {13, 14}, {1, 4}, {2, 6}, {5, 8}, {7, 10}, {9, 13},
+        {11, 14}, {2, 4}, {3, 6}, {9, 12}, {11, 13}, {3, 5}, {6, 8}, {7, 9}, {10, 12}, {3, 4},
+        {5, 6}, {7, 8}, {9, 10}, {11, 12}, {6, 7}, {8, 9}};
+};
+
+template <>
+struct SortingNetwork<16>
+{
+    static constexpr NetworkComparator comparators[] = {
+        {0, 13}, {1, 12}, {2, 15}, {3, 14}, {4, 8}, {5, 6}, {7, 11}, {9, 10}, {0, 5}, {1, 7},
+        {2, 9}, {3, 4}, {6, 13}, {8, 14}, {10, 15}, {11, 12}, {0, 1}, {2, 3}, {4, 5}, {6, 8},
+        {7, 9}, {10, 11}, {12, 13}, {14, 15}, {0, 2}, {1, 3}, {4, 10}, {5, 11}, {6, 7}, {8, 9},
+        {12, 14}, {13, 15}, {1, 2}, {3, 12}, {4, 6}, {5, 7}, {8, 10}, {9, 11}, {13, 14}, {1, 4},
+        {2, 6}, {5, 8}, {7, 10}, {9, 13}, {11, 14}, {2, 4}, {3, 6}, {9, 12}, {11, 13}, {3, 5},
+        {6, 8}, {7, 9}, {10, 12}, {3, 4}, {5, 6}, {7, 8}, {9, 10}, {11, 12}, {6, 7}, {8, 9}};
+};
+
+// Упорядочивает пару без условных переходов. Для целых это min/max.
+// У чисел с плавающей точкой min/max теряют одно из равных значений
+// (0.0 и -0.0), поэтому обмен делается маской над битовым представлением
+template <typename T, typename Compare>
+inline void compare_exchange(T &a, T &b, Compare comp)
+{
+    T x = a;
+    T y = b;
+
+    if constexpr (std::is_integral<T>::value)
+    {
+        a = comp(y, x) ? y : x;
+        b = comp(x, y) ? y : x;
+    }
+    else
+    {
+        using Bits = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+        Bits mask = Bits(0) - Bits(comp(y, x));
+        Bits xb, yb;
+        std::memcpy(&xb, &x, sizeof(T));
+        std::memcpy(&yb, &y, sizeof(T));
+        Bits diff = (xb ^ yb) & mask;
+        xb ^= diff;
+        yb ^= diff;
+        std::memcpy(&a, &xb, sizeof(T));
+        std::memcpy(&b, &yb, sizeof(T));
+    }
+}
+
+// Сеть разворачивается во время компиляции в линейную последовательность
+// сравнений-обменов с постоянными индексами
+template <std::size_t N, typename T, typename Compare, std::size_t... I>
+inline void apply_sorting_network(T *first, Compare comp, std::index_sequence<I...>)
+{
+    (compare_exchange(first[SortingNetwork<N>::comparators[I].i], first[SortingNetwork<N>::comparators[I].j], comp),
+     ...);
+}
+
+template <std::size_t N, typename T, typename Compare>
+void sorting_network(T *first, Compare comp)
+{
+    constexpr std::size_t size = sizeof(SortingNetwork<N>::comparators) / sizeof(NetworkComparator);
+    apply_sorting_network<N>(first, comp, std::make_index_sequence<size>());
+}
+
+// Таблица сетей для размеров 2..SORTING_NETWORK_MAX_SIZE строится во время
+// компиляции, выбор сети — один косвенный вызов
+template <typename T, typename Compare, std::size_t... I>
+void sorting_network_dispatch(T *first, std::size_t n, Compare comp, std::index_sequence<I...>)
+{
+    using Network = void (*)(T *, Compare);
+    static constexpr Network networks[] = {&sorting_network<I + 2, T, Compare>...};
+    networks[n - 2](first, comp);
+}
+
+// Сортирует диапазон длиной не больше SORTING_NETWORK_MAX_SIZE
+template <typename T, typename Compare>
+void sorting_network_sort(T *first, T *last, Compare comp)
+{
+    std::size_t n = static_cast<std::size_t>(last - first);
+    if (n < 2)
+        return;
+
+    sorting_network_dispatch(first, n, comp, std::make_index_sequence<SORTING_NETWORK_MAX_SIZE - 1>());
+}
+
+#endif // SORTING_NETWORK_H
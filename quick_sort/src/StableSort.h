@@ -0,0 +1,469 @@
+#ifndef STABLE_SORT_H
+#define STABLE_SORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "QuickSort.h"
+
+// Серии короче минимальной длины (от MIN_MERGE / 2 до MIN_MERGE)
+// добиваются сортировкой бинарными вставками
+constexpr std::ptrdiff_t STABLE_SORT_MIN_MERGE = 32;
+// Сколько раз подряд должна выиграть одна серия, чтобы слияние перешло в режим галопа
+constexpr std::ptrdiff_t STABLE_SORT_MIN_GALLOP = 7;
+
+// Позиция первого элемента base[0..len), не меньшего key (как lower_bound).
+// Поиск экспоненциальный от hint, поэтому стоит O(log d), где d — расстояние
+// от подсказки до ответа
+template <typename T, typename Compare>
+std::ptrdiff_t gallop_left(const T &key, const T *base, std::ptrdiff_t len, std::ptrdiff_t hint, Compare comp)
+{
+    std::ptrdiff_t last_ofs = 0;
+    std::ptrdiff_t ofs = 1;
+
+    if (comp(base[hint], key))
+    {
+        std::ptrdiff_t max_ofs = len - hint;
+        while (ofs < max_ofs && comp(base[hint + ofs], key))
+        {
+            last_ofs = ofs;
+            ofs = 2 * ofs + 1;
+        }
+        if (ofs > max_ofs)
+            ofs = max_ofs;
+
+        last_ofs += hint;
+        ofs += hint;
+    }
+    else
+    {
+        std::ptrdiff_t max_ofs = hint + 1;
+        while (ofs < max_ofs && !comp(base[hint - ofs], key))
+        {
+            last_ofs = ofs;
+            ofs = 2 * ofs + 1;
+        }
+        if (ofs > max_ofs)
+            ofs = max_ofs;
+
+        std::ptrdiff_t tmp = last_ofs;
+        last_ofs = hint - ofs;
+        ofs = hint - tmp;
+    }
+
+    // base[last_ofs] < key <= base[ofs], остаётся двоичный поиск
+    ++last_ofs;
+    while (last_ofs < ofs)
+    {
+        std::ptrdiff_t m = last_ofs + (ofs - last_ofs) / 2;
+        if (comp(base[m], key))
+            last_ofs = m + 1;
+        else
+            ofs = m;
+    }
+    return ofs;
+}
+
+// Позиция первого элемента base[0..len), большего key (как upper_bound)
+template <typename T, typename Compare>
+std::ptrdiff_t gallop_right(const T &key, const T *base, std::ptrdiff_t len, std::ptrdiff_t hint, Compare comp)
+{
+    std::ptrdiff_t last_ofs = 0;
+    std::ptrdiff_t ofs = 1;
+
+    if (comp(key, base[hint]))
+    {
+        std::ptrdiff_t max_ofs = hint + 1;
+        while (ofs < max_ofs && comp(key, base[hint - ofs]))
+        {
+            last_ofs = ofs;
+            ofs = 2 * ofs + 1;
+        }
+        if (ofs > max_ofs)
+            ofs = max_ofs;
+
+        std::ptrdiff_t tmp = last_ofs;
+        last_ofs = hint - ofs;
+        ofs = hint - tmp;
+    }
+    else
+    {
+        std::ptrdiff_t max_ofs = len - hint;
+        while (ofs < max_ofs && !comp(key, base[hint + ofs]))
+        {
+            last_ofs = ofs;
+            ofs = 2 * ofs + 1;
+        }
+        if (ofs > max_ofs)
+            ofs = max_ofs;
+
+        last_ofs += hint;
+        ofs += hint;
+    }
+
+    // base[last_ofs] <= key < base[ofs]
+    ++last_ofs;
+    while (last_ofs < ofs)
+    {
+        std::ptrdiff_t m = last_ofs + (ofs - last_ofs) / 2;
+        if (comp(key, base[m]))
+            ofs = m;
+        else
+            last_ofs = m + 1;
+    }
+    return ofs;
+}
+
+// Устойчивая сортировка вставками, [first, start) уже отсортирован.
+// Место ищется галопом от конца, так что почти упорядоченный вход дешевле
+template <typename T, typename Compare>
+void binary_insertion_sort(T *first, T *start, T *last, Compare comp)
+{
+    for (T *i = start; i != last; ++i)
+    {
+        T *pos = first + gallop_right(*i, first, i - first, i - first - 1, comp);
+        if (pos == i)
+            continue;
+
+        T temp = std::move(*i);
+        std::move_backward(pos, i, i + 1);
+        *pos = std::move(temp);
+    }
+}
+
+// Длина серии, начинающейся в first. Строго убывающая серия разворачивается
+// на месте: строгость нужна, чтобы не нарушить порядок равных элементов
+template <typename T, typename Compare>
+std::ptrdiff_t count_run_and_make_ascending(T *first, T *last, Compare comp)
+{
+    T *run = first + 1;
+    if (run == last)
+        return 1;
+
+    if (comp(*run, *first))
+    {
+        while (run + 1 != last && comp(*(run + 1), *run))
+            ++run;
+        ++run;
+        reverse(first, run);
+    }
+    else
+    {
+        while (run + 1 != last && !comp(*(run + 1), *run))
+            ++run;
+        ++run;
+    }
+    return run - first;
+}
+
+// Минимальная длина серии: n / minrun близко к степени двойки,
+// чтобы слияния оставались сбалансированными
+inline std::ptrdiff_t stable_sort_min_run(std::ptrdiff_t n)
+{
+    std::ptrdiff_t r = 0;
+    while (n >= STABLE_SORT_MIN_MERGE)
+    {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+// Слияние [a, b) и [b, last) с копией левой серии в буфере. В режиме галопа
+// вместо поэлементного сравнения сразу переносятся целые отрезки серии,
+// которая выигрывает подряд; min_gallop подстраивается под данные
+template <typename T, typename Compare>
+void merge_lo(T *a, T *b, T *last, T *buffer, std::ptrdiff_t &min_gallop, Compare comp)
+{
+    T *cur1 = buffer;
+    T *end1 = std::move(a, b, buffer);
+    T *cur2 = b;
+    T *dest = a;
+
+    std::ptrdiff_t count1 = 0;
+    std::ptrdiff_t count2 = 0;
+    bool galloping = false;
+
+    while (cur1 != end1 && cur2 != last)
+    {
+        if (!galloping)
+        {
+            if (comp(*cur2, *cur1))
+            {
+                *dest++ = std::move(*cur2++);
+                ++count2;
+                count1 = 0;
+            }
+            else
+            {
+                *dest++ = std::move(*cur1++);
+                ++count1;
+                count2 = 0;
+            }
+            galloping = count1 >= min_gallop || count2 >= min_gallop;
+            continue;
+        }
+
+        std::ptrdiff_t run1 = gallop_right(*cur2, cur1, end1 - cur1, 0, comp);
+        dest = std::move(cur1, cur1 + run1, dest);
+        cur1 += run1;
+        if (cur1 == end1)
+            break;
+        *dest++ = std::move(*cur2++);
+        if (cur2 == last)
+            break;
+
+        std::ptrdiff_t run2 = gallop_left(*cur1, cur2, last - cur2, 0, comp);
+        dest = std::move(cur2, cur2 + run2, dest);
+        cur2 += run2;
+        if (cur2 == last)
+            break;
+        *dest++ = std::move(*cur1++);
+
+        if (run1 < STABLE_SORT_MIN_GALLOP && run2 < STABLE_SORT_MIN_GALLOP)
+        {
+            galloping = false;
+            count1 = count2 = 0;
+            min_gallop += 2;
+        }
+        else if (min_gallop > 1)
+        {
+            --min_gallop;
+        }
+    }
+
+    // Остаток правой серии уже на месте
+    std::move(cur1, end1, dest);
+}
+
+// Зеркальное слияние с конца, в буфере копия правой серии
+template <typename T, typename Compare>
+void merge_hi(T *a, T *b, T *last, T *buffer, std::ptrdiff_t &min_gallop, Compare comp)
+{
+    T *begin2 = buffer;
+    T *cur2 = std::move(b, last, buffer);
+    T *cur1 = b;
+    T *dest = last;
+
+    std::ptrdiff_t count1 = 0;
+    std::ptrdiff_t count2 = 0;
+    bool galloping = false;
+
+    while (cur1 != a && cur2 != begin2)
+    {
+        if (!galloping)
+        {
+            if (comp(*(cur2 - 1), *(cur1 - 1)))
+            {
+                *--dest = std::move(*--cur1);
+                ++count1;
+                count2 = 0;
+            }
+            else
+            {
+                *--dest = std::move(*--cur2);
+                ++count2;
+                count1 = 0;
+            }
+            galloping = count1 >= min_gallop || count2 >= min_gallop;
+            continue;
+        }
+
+        std::ptrdiff_t len1 = cur1 - a;
+        std::ptrdiff_t run1 = len1 - gallop_right(*(cur2 - 1), a, len1, len1 - 1, comp);
+        dest = std::move_backward(cur1 - run1, cur1, dest);
+        cur1 -= run1;
+        if (cur1 == a)
+            break;
+        *--dest = std::move(*--cur2);
+        if (cur2 == begin2)
+            break;
+
+        std::ptrdiff_t len2 = cur2 - begin2;
+        std::ptrdiff_t run2 = len2 - gallop_left(*(cur1 - 1), begin2, len2, len2 - 1, comp);
+        dest = std::move_backward(cur2 - run2, cur2, dest);
+        cur2 -= run2;
+        if (cur2 == begin2)
+            break;
+        *--dest = std::move(*--cur1);
+
+        if (run1 < STABLE_SORT_MIN_GALLOP && run2 < STABLE_SORT_MIN_GALLOP)
+        {
+            galloping = false;
+            count1 = count2 = 0;
+            min_gallop += 2;
+        }
+        else if (min_gallop > 1)
+        {
+            --min_gallop;
+        }
+    }
+
+    std::move_backward(begin2, cur2, dest);
+}
+
+// Слияние соседних отсортированных [first, middle) и [middle, last).
+// Сначала галопом отрезаются элементы, которые уже на своих местах. Если
+// меньшая из серий помещается в буфер, слияние идёт через него, иначе
+// диапазон делится поворотом (rotate) на два меньших слияния — без буфера
+// это слияние на месте за O(n log n)
+template <typename T, typename Compare>
+void merge_runs(T *first, T *middle, T *last, T *buffer, std::ptrdiff_t buffer_size,
+                std::ptrdiff_t &min_gallop, Compare comp)
+{
+    if (first == middle || middle == last)
+        return;
+
+    first += gallop_right(*middle, first, middle - first, 0, comp);
+    if (first == middle)
+        return;
+    last = middle + gallop_left(*(middle - 1), middle, last - middle, last - middle - 1, comp);
+    if (middle == last)
+        return;
+
+    std::ptrdiff_t len1 = middle - first;
+    std::ptrdiff_t len2 = last - middle;
+
+    if (len1 <= len2 && len1 <= buffer_size)
+    {
+        merge_lo(first, middle, last, buffer, min_gallop, comp);
+        return;
+    }
+    if (len2 <= buffer_size)
+    {
+        merge_hi(first, middle, last, buffer, min_gallop, comp);
+        return;
+    }
+    if (len1 + len2 == 2)
+    {
+        swap(*first, *middle);
+        return;
+    }
+
+    T *cut1;
+    T *cut2;
+    if (len1 > len2)
+    {
+        cut1 = first + len1 / 2;
+        cut2 = middle + gallop_left(*cut1, middle, len2, 0, comp);
+    }
+    else
+    {
+        cut2 = middle + len2 / 2;
+        cut1 = first + gallop_right(*cut2, first, len1, 0, comp);
+    }
+
+    // Поворот [cut1, cut2) тремя разворотами
+    reverse(cut1, middle);
+    reverse(middle, cut2);
+    reverse(cut1, cut2);
+    T *new_middle = cut1 + (cut2 - middle);
+
+    merge_runs(first, cut1, new_middle, buffer, buffer_size, min_gallop, comp);
+    merge_runs(new_middle, cut2, last, buffer, buffer_size, min_gallop, comp);
+}
+
+// Устойчивая сортировка TimSort: вход разбивается на естественные серии
+// (убывающие разворачиваются, короткие добиваются вставками до minrun),
+// серии складываются в стек и сливаются так, чтобы длины в стеке убывали
+// быстрее чисел Фибоначчи. Отсортированный и почти отсортированный вход
+// обрабатывается за O(n). buffer — рабочая память вызывающего из buffer_size
+// сконструированных элементов; n / 2 достаточно, при меньшем буфере
+// часть слияний выполняется на месте поворотами
+template <typename T, typename Compare>
+void stable_sort(T *first, T *last, Compare comp, T *buffer, std::ptrdiff_t buffer_size)
+{
+    std::ptrdiff_t n = last - first;
+    if (n < 2)
+        return;
+
+    struct Run
+    {
+        T *base;
+        std::ptrdiff_t length;
+    };
+    std::vector<Run> runs;
+    std::ptrdiff_t min_gallop = STABLE_SORT_MIN_GALLOP;
+    std::ptrdiff_t min_run = stable_sort_min_run(n);
+
+    auto merge_at = [&](std::size_t i)
+    {
+        merge_runs(runs[i].base, runs[i + 1].base, runs[i + 1].base + runs[i + 1].length,
+                   buffer, buffer_size, min_gallop, comp);
+        runs[i].length += runs[i + 1].length;
+        runs.erase(runs.begin() + i + 1);
+    };
+
+    T *low = first;
+    while (low != last)
+    {
+        std::ptrdiff_t remaining = last - low;
+        std::ptrdiff_t length = count_run_and_make_ascending(low, last, comp);
+        if (length < min_run)
+        {
+            std::ptrdiff_t forced = remaining < min_run ? remaining : min_run;
+            binary_insertion_sort(low, low + length, low + forced, comp);
+            length = forced;
+        }
+
+        runs.push_back({low, length});
+        low += length;
+
+        // Инвариант стека с поправкой de Gouw и др. (2015): проверяются
+        // три верхние серии, а не две
+        while (runs.size() > 1)
+        {
+            std::size_t k = runs.size() - 2;
+            if ((k > 0 && runs[k - 1].length <= runs[k].length + runs[k + 1].length) ||
+                (k > 1 && runs[k - 2].length <= runs[k - 1].length + runs[k].length))
+            {
+                if (runs[k - 1].length < runs[k + 1].length)
+                    --k;
+            }
+            else if (runs[k].length > runs[k + 1].length)
+            {
+                break;
+            }
+            merge_at(k);
+        }
+    }
+
+    while (runs.size() > 1)
+    {
+        std::size_t k = runs.size() - 2;
+        if (k > 0 && runs[k - 1].length < runs[k + 1].length)
+            --k;
+        merge_at(k);
+    }
+}
+
+// Буфер на n / 2 элементов выделяется сам; если выделить память не удалось
+// или T не конструируется по умолчанию, слияния выполняются на месте
+template <typename T, typename Compare>
+void stable_sort(T *first, T *last, Compare comp)
+{
+    std::ptrdiff_t n = last - first;
+    if (n < 2)
+        return;
+
+    std::unique_ptr<T[]> buffer;
+    std::ptrdiff_t buffer_size = 0;
+    if constexpr (std::is_default_constructible<T>::value)
+    {
+        if (n >= 2 * STABLE_SORT_MIN_MERGE)
+        {
+            buffer.reset(new (std::nothrow) T[n / 2]);
+            if (buffer)
+                buffer_size = n / 2;
+        }
+    }
+
+    stable_sort(first, last, comp, buffer.get(), buffer_size);
+}
+
+#endif // STABLE_SORT_H
@@ -0,0 +1,140 @@
+#ifndef STRING_SORT_H
+#define STRING_SORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "CompareTraits.h"
+#include "Permutation.h"
+
+template <typename T, typename Compare>
+void quicksort(T *first, T *last, Compare comp);
+
+// Число символов строки, упаковываемых в одно слово ключа
+constexpr std::size_t STRING_SORT_WORD_CHARS = 7;
+
+template <typename T>
+constexpr bool is_sortable_string = std::is_same<T, std::string>::value || std::is_same<T, std::string_view>::value;
+
+// Сравнение std::string и std::string_view по умолчанию побайтовое как
+// unsigned char, поэтому его можно заменить поразрядным алгоритмом
+template <typename T, typename Compare>
+constexpr bool use_string_sort = is_sortable_string<T> && is_standard_compare<T, Compare>::value;
+
+// До STRING_SORT_WORD_CHARS символов строки начиная с depth как беззнаковое
+// число big-endian, младший байт — сколько символов взято. Порядок слов
+// совпадает с порядком строк на этих символах, а строка, закончившаяся
+// раньше, меньше своего продолжения
+inline std::uint64_t string_word_at(const char *data, std::size_t size, std::size_t depth)
+{
+    std::size_t count = depth < size ? size - depth : 0;
+    if (count > STRING_SORT_WORD_CHARS)
+        count = STRING_SORT_WORD_CHARS;
+
+    std::uint64_t word = 0;
+    const char *p = data + depth;
+    for (std::size_t i = 0; i < count; ++i)
+        word |= std::uint64_t(static_cast<unsigned char>(p[i])) << (56 - 8 * i);
+    return word | count;
+}
+
+// Слово ключа строки, её символы и исходная позиция. Символы адресуются
+// напрямую, чтобы перечитывание слова не обращалось к объекту строки
+struct StringWordEntry
+{
+    std::uint64_t word;
+    const char *data;
+    std::size_t size;
+    std::size_t index;
+};
+
+struct StringWordLess
+{
+    bool operator()(const StringWordEntry &a, const StringWordEntry &b) const
+    {
+        return a.word < b.word;
+    }
+};
+
+// Группа записей с одинаковыми первыми depth символами строк
+struct StringWordRange
+{
+    StringWordEntry *first;
+    StringWordEntry *last;
+    std::size_t depth;
+};
+
+// Поразрядная сортировка MSD по словам из STRING_SORT_WORD_CHARS символов.
+// Записи с закэшированными словами сортируются без обращения к строкам;
+// только группы с одинаковым полным словом перечитывают следующее слово
+// своих строк и сортируются дальше. Общий префикс читается по одному разу
+// на строку, а не при каждом сравнении. Глубина спуска пропорциональна
+// длине общего префикса, поэтому группы хранятся в явном стеке, а не в
+// стеке вызовов
+inline void string_word_sort(StringWordEntry *first, StringWordEntry *last, std::size_t depth)
+{
+    std::vector<StringWordRange> stack;
+    stack.push_back(StringWordRange{first, last, depth});
+
+    while (!stack.empty())
+    {
+        StringWordRange range = stack.back();
+        stack.pop_back();
+
+        quicksort(range.first, range.last, StringWordLess());
+
+        for (StringWordEntry *group = range.first; group != range.last;)
+        {
+            StringWordEntry *end = group + 1;
+            while (end != range.last && end->word == group->word)
+                ++end;
+
+            // Строки, закончившиеся в пределах слова, равны между собой
+            if (end - group > 1 && (group->word & 0xff) == STRING_SORT_WORD_CHARS)
+            {
+                std::size_t next = range.depth + STRING_SORT_WORD_CHARS;
+                for (StringWordEntry *e = group; e != end; ++e)
+                    e->word = string_word_at(e->data, e->size, next);
+                stack.push_back(StringWordRange{group, end, next});
+            }
+            group = end;
+        }
+    }
+}
+
+// Сортировка строк стандартным компаратором: упорядочиваются кэшированные
+// слова ключей, затем каждая строка перемещается на место один раз.
+// По убыванию — результат в обратном порядке (равные строки неразличимы)
+template <typename T, typename Compare>
+void string_sort(T *first, T *last, Compare)
+{
+    std::size_t n = static_cast<std::size_t>(last - first);
+
+    std::vector<StringWordEntry> entries(n);
+    for (std::size_t i = 0; i < n; ++i)
+        entries[i] = StringWordEntry{string_word_at(first[i].data(), first[i].size(), 0), first[i].data(), first[i].size(), i};
+
+    string_word_sort(entries.data(), entries.data() + n, 0);
+
+    std::vector<std::size_t> order(n);
+    if constexpr (is_descending_compare<T, Compare>::value)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            order[i] = entries[n - 1 - i].index;
+    }
+    else
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            order[i] = entries[i].index;
+    }
+    std::vector<StringWordEntry>().swap(entries);
+
+    apply_permutation_buffered(first, order.data(), n);
+}
+
+#endif // STRING_SORT_H
@@ -0,0 +1,211 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Пул потоков с воровством задач. У каждого потока своя очередь: задачи,
+// порождённые внутри пула, кладутся в конец очереди своего потока и берутся
+// им оттуда же, а простаивающие потоки крадут задачи из начала чужих очередей.
+// Пул создаётся один раз и переиспользуется между вызовами сортировок
+class ThreadPool final
+{
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::atomic<std::ptrdiff_t> queued_{0};
+    std::atomic<std::size_t> next_queue_{0};
+    bool stop_ = false;
+
+    inline static thread_local ThreadPool *current_pool_ = nullptr;
+    inline static thread_local std::size_t current_index_ = 0;
+
+    bool pop_local(std::size_t index, std::function<void()> &task)
+    {
+        WorkQueue &queue = *queues_[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(std::size_t index, std::function<void()> &task)
+    {
+        for (std::size_t i = 1; i <= queues_.size(); ++i)
+        {
+            WorkQueue &queue = *queues_[(index + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+                continue;
+
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    bool take_task(std::size_t index, std::function<void()> &task)
+    {
+        if (pop_local(index, task) || steal(index, task))
+        {
+            --queued_;
+            return true;
+        }
+        return false;
+    }
+
+    void worker_loop(std::size_t index)
+    {
+        current_pool_ = this;
+        current_index_ = index;
+
+        while (true)
+        {
+            std::function<void()> task;
+            if (take_task(index, task))
+            {
+                task();
+                continue;
+            }
+
+            // При остановке поток выходит, только когда очереди пусты:
+            // выполняемая задача могла добавить новые, их подберёт этот же
+            // или другой поток
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_.wait(lock, [this]
+                       { return stop_ || queued_ > 0; });
+            if (stop_ && queued_ == 0)
+                return;
+        }
+    }
+
+public:
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency())
+    {
+        if (threads == 0)
+            threads = 1;
+
+        for (std::size_t i = 0; i < threads; ++i)
+            queues_.push_back(std::make_unique<WorkQueue>());
+
+        for (std::size_t i = 0; i < threads; ++i)
+            workers_.emplace_back([this, i]
+                                  { worker_loop(i); });
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Дожидается выполнения всех поставленных задач, в том числе
+    // порождённых ими во время остановки
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+
+        for (std::thread &worker : workers_)
+            worker.join();
+    }
+
+    std::size_t size() const
+    {
+        return workers_.size();
+    }
+
+    // Ставит задачу в очередь. Задача не должна бросать исключений: как и
+    // в std::thread, исключение из задачи в рабочем потоке вызывает
+    // std::terminate(). Ошибки передаются через состояние задачи,
+    // как это делает parallel_for()
+    void submit(std::function<void()> task)
+    {
+        std::size_t index = current_pool_ == this
+                                ? current_index_
+                                : next_queue_++ % queues_.size();
+        {
+            WorkQueue &queue = *queues_[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            ++queued_;
+        }
+        wake_.notify_one();
+    }
+
+    // Выполняет одну ожидающую задачу в текущем потоке. Позволяет
+    // ожидающему результата потоку помогать пулу, а не простаивать
+    bool run_pending_task()
+    {
+        std::size_t index = current_pool_ == this ? current_index_ : 0;
+
+        std::function<void()> task;
+        if (!take_task(index, task))
+            return false;
+
+        task();
+        return true;
+    }
+
+    // Выполняет fn(0), ..., fn(count - 1) задачами пула и ждёт их завершения,
+    // помогая пулу. Первое выброшенное исключение пробрасывается вызывающему
+    template <typename Function>
+    void parallel_for(std::size_t count, Function fn)
+    {
+        std::atomic<std::size_t> pending{count};
+        std::mutex error_mutex;
+        std::exception_ptr error;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            submit([&, i]
+                   {
+                       try
+                       {
+                           fn(i);
+                       }
+                       catch (...)
+                       {
+                           std::lock_guard<std::mutex> lock(error_mutex);
+                           if (!error)
+                               error = std::current_exception();
+                       }
+                       --pending; });
+        }
+
+        while (pending > 0)
+        {
+            if (!run_pending_task())
+                std::this_thread::yield();
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+#endif // THREAD_POOL_H
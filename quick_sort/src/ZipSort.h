@@ -0,0 +1,216 @@
+#ifndef ZIP_SORT_H
+#define ZIP_SORT_H
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+#include "QuickSort.h"
+
+// Колонки одинаковой длины: ключи и произвольное число колонок значений.
+// Строка i — ключ и i-е элементы всех колонок; каждое перемещение строки
+// применяется ко всем колонкам сразу, промежуточных структур нет
+template <typename Key, typename... Values>
+class ZipColumns final
+{
+    Key *keys_;
+    std::tuple<Values *...> values_;
+
+public:
+    using Row = std::tuple<Key, Values...>;
+
+    explicit ZipColumns(Key *keys, Values *...values) : keys_(keys), values_(values...) {}
+
+    const Key &key(std::ptrdiff_t i) const
+    {
+        return keys_[i];
+    }
+
+    void swap_rows(std::ptrdiff_t i, std::ptrdiff_t j)
+    {
+        swap(keys_[i], keys_[j]);
+        std::apply([i, j](Values *...columns)
+                   { (swap(columns[i], columns[j]), ...); },
+                   values_);
+    }
+
+    Row take(std::ptrdiff_t i)
+    {
+        return std::apply([this, i](Values *...columns)
+                          { return Row(std::move(keys_[i]), std::move(columns[i])...); },
+                          values_);
+    }
+
+    void put(std::ptrdiff_t i, Row &&row)
+    {
+        keys_[i] = std::move(std::get<0>(row));
+        put_values(i, row, std::index_sequence_for<Values...>());
+    }
+
+    void move_row(std::ptrdiff_t to, std::ptrdiff_t from)
+    {
+        keys_[to] = std::move(keys_[from]);
+        std::apply([to, from](Values *...columns)
+                   { ((columns[to] = std::move(columns[from])), ...); },
+                   values_);
+    }
+
+private:
+    template <std::size_t... I>
+    void put_values([[maybe_unused]] std::ptrdiff_t i, [[maybe_unused]] Row &row, std::index_sequence<I...>)
+    {
+        ((std::get<I>(values_)[i] = std::move(std::get<I + 1>(row))), ...);
+    }
+};
+
+template <typename Zip, typename Compare>
+void zip_insertion_sort(Zip &zip, std::ptrdiff_t first, std::ptrdiff_t last, Compare comp)
+{
+    for (std::ptrdiff_t i = first + 1; i < last; ++i)
+    {
+        if (!comp(zip.key(i), zip.key(i - 1)))
+            continue;
+
+        typename Zip::Row temp = zip.take(i);
+        std::ptrdiff_t j = i;
+        do
+        {
+            zip.move_row(j, j - 1);
+            --j;
+        } while (j > first && comp(std::get<0>(temp), zip.key(j - 1)));
+
+        zip.put(j, std::move(temp));
+    }
+}
+
+template <typename Zip, typename Compare>
+std::ptrdiff_t zip_median_of_three(const Zip &zip, std::ptrdiff_t a, std::ptrdiff_t b, std::ptrdiff_t c, Compare comp)
+{
+    if (comp(zip.key(a), zip.key(b)))
+    {
+        if (comp(zip.key(b), zip.key(c)))
+            return b;
+        if (comp(zip.key(a), zip.key(c)))
+            return c;
+        return a;
+    }
+    else
+    {
+        if (comp(zip.key(a), zip.key(c)))
+            return a;
+        if (comp(zip.key(b), zip.key(c)))
+            return c;
+        return b;
+    }
+}
+
+// Разбиение Хоара, останавливающееся на равных опорному с обеих сторон:
+// при множестве дубликатов части получаются сбалансированными.
+// Возвращает итоговую позицию опорной строки
+template <typename Zip, typename Compare>
+std::ptrdiff_t zip_partition(Zip &zip, std::ptrdiff_t first, std::ptrdiff_t last, std::ptrdiff_t pivot, Compare comp)
+{
+    zip.swap_rows(first, pivot);
+    const auto &value = zip.key(first);
+
+    std::ptrdiff_t i = first + 1;
+    std::ptrdiff_t j = last - 1;
+    while (true)
+    {
+        while (i <= j && comp(zip.key(i), value))
+            ++i;
+        while (i <= j && comp(value, zip.key(j)))
+            --j;
+        if (i >= j)
+            break;
+
+        zip.swap_rows(i, j);
+        ++i;
+        --j;
+    }
+
+    zip.swap_rows(first, j);
+    return j;
+}
+
+template <typename Zip, typename Compare>
+void zip_sift_down(Zip &zip, std::ptrdiff_t first, std::ptrdiff_t size, std::ptrdiff_t root, Compare comp)
+{
+    while (true)
+    {
+        std::ptrdiff_t child = 2 * root + 1;
+        if (child >= size)
+            return;
+
+        if (child + 1 < size && comp(zip.key(first + child), zip.key(first + child + 1)))
+            ++child;
+
+        if (!comp(zip.key(first + root), zip.key(first + child)))
+            return;
+
+        zip.swap_rows(first + root, first + child);
+        root = child;
+    }
+}
+
+template <typename Zip, typename Compare>
+void zip_heap_sort(Zip &zip, std::ptrdiff_t first, std::ptrdiff_t last, Compare comp)
+{
+    std::ptrdiff_t size = last - first;
+
+    for (std::ptrdiff_t i = size / 2 - 1; i >= 0; --i)
+        zip_sift_down(zip, first, size, i, comp);
+
+    for (std::ptrdiff_t end = size - 1; end > 0; --end)
+    {
+        zip.swap_rows(first, first + end);
+        zip_sift_down(zip, first, end, 0, comp);
+    }
+}
+
+template <typename Zip, typename Compare>
+void zip_introsort_loop(Zip &zip, std::ptrdiff_t first, std::ptrdiff_t last, Compare comp, int depth_limit)
+{
+    while (last - first > INSERTION_SORT_QUANT)
+    {
+        if (depth_limit == 0)
+        {
+            zip_heap_sort(zip, first, last, comp);
+            return;
+        }
+        --depth_limit;
+
+        std::ptrdiff_t pivot = zip_median_of_three(zip, first, first + (last - first) / 2, last - 1, comp);
+        std::ptrdiff_t p = zip_partition(zip, first, last, pivot, comp);
+
+        if (p - first < last - p - 1)
+        {
+            zip_introsort_loop(zip, first, p, comp, depth_limit);
+            first = p + 1;
+        }
+        else
+        {
+            zip_introsort_loop(zip, p + 1, last, comp, depth_limit);
+            last = p;
+        }
+    }
+
+    zip_insertion_sort(zip, first, last, comp);
+}
+
+// Сортирует ключи [first, last) и переставляет строки колонок values так
+// же, как ключи: values[k][i] остаётся в одной строке с ключом first[i].
+// Каждая колонка должна содержать не меньше last - first элементов.
+// Интроспективная сортировка, O(n log n) в худшем случае; неустойчива
+template <typename Key, typename Compare, typename... Values>
+void sort_zip(Key *first, Key *last, Compare comp, Values *...values)
+{
+    std::ptrdiff_t n = last - first;
+    if (n < 2)
+        return;
+
+    ZipColumns<Key, Values...> zip(first, values...);
+    zip_introsort_loop(zip, 0, n, comp, 2 * floor_log2(n));
+}
+
+#endif // ZIP_SORT_H
@@ -4,6 +4,8 @@
 #include <algorithm>
 #include <chrono>
 #include <random>
+#include <string>
+#include <utility>
 
 #include "QuickSort.h"
 
@@ -88,8 +90,187 @@ void test_insertion_sort_only(std::ofstream& csv_file) {
     }
 }
 
-int main()
+// Калибровка SortTraits: для каждой категории типов перебираются порог
+// сортировки вставками, выбор опорного элемента и схема разбиения,
+// лучшие значения записываются в заголовок SortTuning.h
+
+constexpr int CALIBRATION_QUANTS[] = {4, 8, 12, 16, 24, 32, 48, 64};
+constexpr size_t CALIBRATION_SIZE = 1 << 17;
+constexpr int CALIBRATION_REPEATS = 3;
+
+template <int Quant, PivotStrategy Pivot, PartitionScheme Partition>
+struct CalibrationTraits {
+    static constexpr int insertion_sort_quant = Quant;
+    static constexpr PivotStrategy pivot = Pivot;
+    static constexpr PartitionScheme partition = Partition;
+};
+
+// Представитель категории trivial
+struct CalibrationRecord {
+    int key;
+    int payload[3];
+};
+
+// Представитель категории object: строки сами sort() отдаёт string_sort(),
+// а записи с владеющими полями и дорогим сравнением идут через quicksort()
+struct CalibrationPerson {
+    std::string name;
+    int age;
+};
+
+struct CalibrationResult {
+    int quant = 0;
+    PivotStrategy pivot = PivotStrategy::median_of_three;
+    PartitionScheme partition = PartitionScheme::automatic;
+    double time_ms = 0.0;
+};
+
+const char* pivot_name(PivotStrategy pivot) {
+    switch (pivot) {
+    case PivotStrategy::median_of_three:
+        return "median_of_three";
+    case PivotStrategy::ninther:
+        return "ninther";
+    case PivotStrategy::adaptive:
+        return "adaptive";
+    }
+    return "median_of_three";
+}
+
+const char* partition_name(PartitionScheme partition) {
+    switch (partition) {
+    case PartitionScheme::automatic:
+        return "automatic";
+    case PartitionScheme::hoare:
+        return "hoare";
+    case PartitionScheme::block:
+        return "block";
+    }
+    return "automatic";
+}
+
+template <typename Traits, typename T, typename Compare>
+void calibrate_one(const std::vector<T>& input, Compare comp, CalibrationResult& best) {
+    double best_time = 0.0;
+    for (int repeat = 0; repeat < CALIBRATION_REPEATS; ++repeat) {
+        std::vector<T> arr = input;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        quicksort_tuned<Traits>(arr.data(), arr.data() + arr.size(), comp);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        double time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1e6;
+        if (repeat == 0 || time < best_time) {
+            best_time = time;
+        }
+
+        if (!std::is_sorted(arr.begin(), arr.end(), comp)) {
+            std::cerr << "Ошибка сортировки при калибровке, quant=" << Traits::insertion_sort_quant << "\n";
+        }
+    }
+
+    if (best.quant == 0 || best_time < best.time_ms) {
+        best.quant = Traits::insertion_sort_quant;
+        best.pivot = Traits::pivot;
+        best.partition = Traits::partition;
+        best.time_ms = best_time;
+    }
+}
+
+template <PivotStrategy Pivot, PartitionScheme Partition, typename T, typename Compare, size_t... I>
+void calibrate_quants(const std::vector<T>& input, Compare comp, CalibrationResult& best, std::index_sequence<I...>) {
+    (calibrate_one<CalibrationTraits<CALIBRATION_QUANTS[I], Pivot, Partition>>(input, comp, best), ...);
+}
+
+template <PivotStrategy Pivot, PartitionScheme Partition, typename T, typename Compare>
+void calibrate_quants(const std::vector<T>& input, Compare comp, CalibrationResult& best) {
+    calibrate_quants<Pivot, Partition>(input, comp, best,
+                                       std::make_index_sequence<sizeof(CALIBRATION_QUANTS) / sizeof(int)>());
+}
+
+template <PartitionScheme Partition, typename T, typename Compare>
+void calibrate_pivots(const std::vector<T>& input, Compare comp, CalibrationResult& best) {
+    calibrate_quants<PivotStrategy::median_of_three, Partition>(input, comp, best);
+    calibrate_quants<PivotStrategy::ninther, Partition>(input, comp, best);
+    calibrate_quants<PivotStrategy::adaptive, Partition>(input, comp, best);
+}
+
+template <typename T, typename Compare>
+CalibrationResult calibrate_category(const std::vector<T>& input, Compare comp) {
+    CalibrationResult best;
+    calibrate_pivots<PartitionScheme::hoare>(input, comp, best);
+    calibrate_pivots<PartitionScheme::block>(input, comp, best);
+    if (use_block_partition<T, Compare>) {
+        calibrate_pivots<PartitionScheme::automatic>(input, comp, best);
+    }
+    return best;
+}
+
+void write_tuning(std::ofstream& header, const char* category, const CalibrationResult& result) {
+    header << "#define SORT_TUNING_" << category << "_QUANT " << result.quant << "\n";
+    header << "#define SORT_TUNING_" << category << "_PIVOT " << pivot_name(result.pivot) << "\n";
+    header << "#define SORT_TUNING_" << category << "_PARTITION " << partition_name(result.partition) << "\n";
+
+    std::cout << category << ": quant=" << result.quant << ", pivot=" << pivot_name(result.pivot)
+              << ", partition=" << partition_name(result.partition) << ", time=" << result.time_ms << " ms\n";
+}
+
+int calibrate(const std::string& path) {
+    std::mt19937 gen(std::random_device{}());
+
+    std::vector<int> numbers(CALIBRATION_SIZE);
+    for (int& value : numbers) {
+        value = static_cast<int>(gen());
+    }
+
+    std::vector<CalibrationRecord> records(CALIBRATION_SIZE);
+    for (CalibrationRecord& record : records) {
+        record.key = static_cast<int>(gen());
+        record.payload[0] = record.payload[1] = record.payload[2] = record.key;
+    }
+
+    std::vector<CalibrationPerson> people(CALIBRATION_SIZE);
+    for (CalibrationPerson& person : people) {
+        person.name = "person/";
+        for (int i = 0; i < 16; ++i) {
+            person.name += static_cast<char>('a' + gen() % 26);
+        }
+        person.age = static_cast<int>(gen() % 100);
+    }
+
+    std::cout << "Калибровка на " << CALIBRATION_SIZE << " элементах...\n";
+    CalibrationResult arithmetic = calibrate_category(numbers, std::less<int>());
+    CalibrationResult trivial = calibrate_category(records, [](const CalibrationRecord& a, const CalibrationRecord& b) {
+        return a.key < b.key;
+    });
+    CalibrationResult object = calibrate_category(people, [](const CalibrationPerson& a, const CalibrationPerson& b) {
+        return a.name < b.name || (a.name == b.name && a.age < b.age);
+    });
+
+    std::ofstream header(path);
+    if (!header.is_open()) {
+        std::cerr << "Не удалось открыть файл " << path << "\n";
+        return 1;
+    }
+
+    header << "// Сгенерировано comparison_sorts --calibrate\n";
+    header << "#ifndef SORT_TUNING_H\n#define SORT_TUNING_H\n\n";
+    write_tuning(header, "ARITHMETIC", arithmetic);
+    write_tuning(header, "TRIVIAL", trivial);
+    write_tuning(header, "OBJECT", object);
+    header << "\n#endif // SORT_TUNING_H\n";
+
+    std::cout << "Настройки сохранены в " << path << ", положите его рядом с QuickSort.h\n";
+    return 0;
+}
+
+int main(int argc, char** argv)
 {
+    if (argc > 1 && std::string(argv[1]) == "--calibrate")
+    {
+        return calibrate(argc > 2 ? argv[2] : "SortTuning.h");
+    }
+
     std::cout << "Начало тестирования алгоритмов сортировки...\n";
 
     std::ofstream file1("quicksort_no_insertion.csv");
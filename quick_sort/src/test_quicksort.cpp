@@ -1,13 +1,39 @@
 #include "QuickSort.h"
+#include "AsyncSort.h"
+#include "ExternalSort.h"
+#include "KeySort.h"
+#include "KWayMerge.h"
+#include "ParallelSort.h"
+#include "SampleSort.h"
+#include "SegmentedSort.h"
+#include "SetOps.h"
+#include "SortReduce.h"
+#include "SortedIndex.h"
+#include "Selection.h"
+#include "StableSort.h"
+#include "ZipSort.h"
+#include "ThreadPool.h"
 #include "Array.h"
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
 #include <vector>
 #include <random>
 #include <string>
+#include <string_view>
 #include <climits>
+#include <cstdint>
+#include <cctype>
+#include <cmath>
 #include <cstdlib>
+#include <stdexcept>
 #include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
 
 class QuickSortBasicTest : public ::testing::Test {
 protected:
@@ -389,6 +415,88 @@ TEST_F(QuickSortCornerCasesTest, PartitionCheck) {
     }
 }
 
+TEST_F(QuickSortCornerCasesTest, PartitionThreeWayCheck) {
+    int arr[] = {5, 3, 5, 8, 1, 5, 2, 7, 5, 4, 6, 5};
+    int* pivot = &arr[2];
+
+    std::pair<int*, int*> equal = partition_three_way(arr, arr + 12, pivot, std::less<int>());
+    EXPECT_EQ(equal.first - arr, 4);
+    EXPECT_EQ(equal.second - arr, 9);
+    for (int* p = arr; p != equal.first; ++p) {
+        EXPECT_LT(*p, 5);
+    }
+    for (int* p = equal.first; p != equal.second; ++p) {
+        EXPECT_EQ(*p, 5);
+    }
+    for (int* p = equal.second; p != arr + 12; ++p) {
+        EXPECT_GT(*p, 5);
+    }
+}
+
+TEST_F(QuickSortCornerCasesTest, BlockPartitionCheck) {
+    const int sizes[] = {2, 3, 17, 2 * PARTITION_BLOCK_SIZE, 2 * PARTITION_BLOCK_SIZE + 1, 1000};
+
+    for (int n : sizes) {
+        std::vector<int> arr(n);
+        for (int i = 0; i < n; ++i) {
+            arr[i] = std::rand() % 50;
+        }
+        std::vector<int> expected = arr;
+        std::sort(expected.begin(), expected.end());
+
+        int* p = block_partition(arr.data(), arr.data() + n, &arr[n / 2], std::less<int>()).first;
+        for (int* q = arr.data(); q != p; ++q) {
+            EXPECT_LT(*q, *p) << "size " << n;
+        }
+        for (int* q = p + 1; q != arr.data() + n; ++q) {
+            EXPECT_GE(*q, *p) << "size " << n;
+        }
+
+        std::sort(arr.begin(), arr.end());
+        EXPECT_EQ(arr, expected) << "size " << n;
+    }
+}
+
+TEST_F(QuickSortCornerCasesTest, BlockPartitionGreater) {
+    const int N = 10000;
+    std::vector<double> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = (std::rand() % 100001 - 50000) / 7.0;
+    }
+
+    std::vector<double> expected = arr;
+    std::sort(expected.begin(), expected.end(), std::greater<double>());
+
+    quicksort(arr.data(), arr.data() + N, std::greater<double>());
+
+    EXPECT_EQ(arr, expected);
+}
+
+TEST_F(QuickSortCornerCasesTest, LowCardinalityNearLinear) {
+    const int N = 100000;
+    const int distinct[] = {1, 4, 300};
+
+    for (int k : distinct) {
+        std::vector<int> arr(N);
+        for (int i = 0; i < N; ++i) {
+            arr[i] = std::rand() % k;
+        }
+
+        std::vector<int> expected = arr;
+        std::sort(expected.begin(), expected.end());
+
+        long long comparisons = 0;
+        sort(arr.data(), arr.data() + N, [&comparisons](int a, int b) {
+            ++comparisons;
+            return a < b;
+        });
+
+        EXPECT_EQ(arr, expected) << "distinct keys: " << k;
+        EXPECT_LE(comparisons, 4LL * N * (1 + std::log2(static_cast<double>(k))))
+            << "distinct keys: " << k;
+    }
+}
+
 TEST_F(QuickSortCornerCasesTest, PerformanceTest) {
     const int N = 100000;
     std::vector<int> arr(N);
@@ -406,6 +514,2530 @@ TEST_F(QuickSortCornerCasesTest, PerformanceTest) {
     }
 }
 
+class QuickSortPatternTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    static long long count_comparisons(std::vector<int>& arr) {
+        long long comparisons = 0;
+        sort(arr.data(), arr.data() + arr.size(), [&comparisons](int a, int b) {
+            ++comparisons;
+            return a < b;
+        });
+        return comparisons;
+    }
+
+    static const int N = 100000;
+};
+
+TEST_F(QuickSortPatternTest, SortedIsLinear) {
+    std::vector<int> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = i;
+    }
+
+    EXPECT_LE(count_comparisons(arr), 2LL * N);
+    EXPECT_TRUE(std::is_sorted(arr.begin(), arr.end()));
+}
+
+TEST_F(QuickSortPatternTest, ReverseSortedIsLinear) {
+    std::vector<int> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = N - i;
+    }
+
+    EXPECT_LE(count_comparisons(arr), 2LL * N);
+    for (int i = 0; i < N; ++i) {
+        EXPECT_EQ(arr[i], i + 1);
+    }
+}
+
+TEST_F(QuickSortPatternTest, AppendedRecordsNearLinear) {
+    std::vector<int> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = i < N - 10 ? i : std::rand() % N;
+    }
+
+    std::vector<int> expected = arr;
+    std::sort(expected.begin(), expected.end());
+
+    EXPECT_LE(count_comparisons(arr), 3LL * N);
+    EXPECT_EQ(arr, expected);
+}
+
+TEST_F(QuickSortPatternTest, SawtoothNearLinear) {
+    std::vector<int> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = i % 8;
+    }
+
+    std::vector<int> expected = arr;
+    std::sort(expected.begin(), expected.end());
+
+    EXPECT_LE(count_comparisons(arr), 8LL * N);
+    EXPECT_EQ(arr, expected);
+}
+
+TEST_F(QuickSortPatternTest, OrganPipe) {
+    std::vector<int> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = i < N / 2 ? i : N - i;
+    }
+
+    std::vector<int> expected = arr;
+    std::sort(expected.begin(), expected.end());
+
+    sort(arr.data(), arr.data() + N, std::less<int>());
+    EXPECT_EQ(arr, expected);
+}
+
+TEST_F(QuickSortPatternTest, PartialInsertionSortBailsOut) {
+    std::vector<int> nearly = {1, 2, 4, 3, 5, 6, 8, 7, 9};
+    EXPECT_TRUE(partial_insertion_sort(nearly.data(), nearly.data() + nearly.size(), std::less<int>()));
+    EXPECT_TRUE(std::is_sorted(nearly.begin(), nearly.end()));
+
+    std::vector<int> reversed(100);
+    for (int i = 0; i < 100; ++i) {
+        reversed[i] = 100 - i;
+    }
+    std::vector<int> expected = reversed;
+    std::sort(expected.begin(), expected.end());
+
+    EXPECT_FALSE(partial_insertion_sort(reversed.data(), reversed.data() + reversed.size(), std::less<int>()));
+    std::sort(reversed.begin(), reversed.end());
+    EXPECT_EQ(reversed, expected);
+}
+
+class QuickSortAdversarialTest : public ::testing::Test {
+protected:
+    // Противник Макилроя ("A Killer Adversary for Quicksort"): значения
+    // элементов фиксируются лениво, так что любой выбор опорного элемента
+    // оказывается неудачным. Ответы согласованы, поэтому после сортировки
+    // val задаёт реальный входной массив, ломающий обычный quicksort.
+    struct KillerAdversary {
+        std::vector<int> val;
+        int gas;
+        int nsolid = 0;
+        int candidate = 0;
+        long long comparisons = 0;
+
+        explicit KillerAdversary(int n) : val(n, n), gas(n) {}
+
+        bool less(int x, int y) {
+            ++comparisons;
+            if (val[x] == gas && val[y] == gas) {
+                val[x == candidate ? x : y] = nsolid++;
+            }
+            if (val[x] == gas) {
+                candidate = x;
+            } else if (val[y] == gas) {
+                candidate = y;
+            }
+            return val[x] < val[y];
+        }
+    };
+
+    static double n_log_n(int n) {
+        return n * std::log2(static_cast<double>(n));
+    }
+};
+
+TEST_F(QuickSortAdversarialTest, KillerAdversaryStaysNLogN) {
+    const int N = 20000;
+    KillerAdversary adversary(N);
+    std::vector<int> items(N);
+    for (int i = 0; i < N; ++i) {
+        items[i] = i;
+    }
+
+    // Предварительный поиск серий в quicksort() противник проходит как
+    // отсортированный вход, поэтому атакуется сам цикл разбиений
+    introsort_loop(items.data(), items.data() + N, [&adversary](int a, int b) {
+        return adversary.less(a, b);
+    }, 2 * floor_log2(N));
+
+    EXPECT_LE(adversary.comparisons, 6 * n_log_n(N));
+    for (int i = 0; i < N - 1; ++i) {
+        EXPECT_LT(adversary.val[items[i]], adversary.val[items[i + 1]]) << "Not sorted at index " << i;
+    }
+}
+
+TEST_F(QuickSortAdversarialTest, GeneratedKillerInputStaysNLogN) {
+    const int N = 20000;
+    KillerAdversary adversary(N);
+    std::vector<int> items(N);
+    for (int i = 0; i < N; ++i) {
+        items[i] = i;
+    }
+    introsort_loop(items.data(), items.data() + N, [&adversary](int a, int b) {
+        return adversary.less(a, b);
+    }, 2 * floor_log2(N));
+
+    std::vector<int> arr = adversary.val;
+    long long comparisons = 0;
+    sort(arr.data(), arr.data() + N, [&comparisons](int a, int b) {
+        ++comparisons;
+        return a < b;
+    });
+
+    EXPECT_LE(comparisons, 6 * n_log_n(N));
+    for (int i = 0; i < N - 1; ++i) {
+        EXPECT_LE(arr[i], arr[i + 1]) << "Not sorted at index " << i;
+    }
+}
+
+TEST_F(QuickSortAdversarialTest, HeapSort) {
+    const int N = 1000;
+    std::vector<int> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = std::rand() % 101;
+    }
+
+    std::vector<int> expected = arr;
+    std::sort(expected.begin(), expected.end());
+
+    heap_sort(arr.data(), arr.data() + N, std::less<int>());
+
+    EXPECT_EQ(arr, expected);
+}
+
+class RadixSortTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    template <typename T, typename Compare>
+    static void check_sort(std::vector<T> arr, Compare comp) {
+        std::vector<T> expected = arr;
+        std::sort(expected.begin(), expected.end(), comp);
+
+        sort(arr.data(), arr.data() + arr.size(), comp);
+
+        EXPECT_EQ(arr, expected);
+    }
+
+    static const int N = 10000;
+};
+
+TEST_F(RadixSortTest, KeyTransformPreservesOrder) {
+    EXPECT_LT(to_radix_key(INT_MIN), to_radix_key(-1));
+    EXPECT_LT(to_radix_key(-1), to_radix_key(0));
+    EXPECT_LT(to_radix_key(0), to_radix_key(INT_MAX));
+
+    EXPECT_LT(to_radix_key(-1e300), to_radix_key(-2.5));
+    EXPECT_LT(to_radix_key(-2.5), to_radix_key(-1e-300));
+    EXPECT_LT(to_radix_key(-1e-300), to_radix_key(0.0));
+    EXPECT_LT(to_radix_key(0.0), to_radix_key(1e-300));
+    EXPECT_LT(to_radix_key(1e-300), to_radix_key(3.0));
+    EXPECT_LT(to_radix_key(-0.5f), to_radix_key(0.25f));
+}
+
+TEST_F(RadixSortTest, IntegralTypes) {
+    std::vector<int> ints(N);
+    std::vector<std::int64_t> longs(N);
+    std::vector<std::uint32_t> unsigneds(N);
+    std::vector<short> shorts(N);
+    for (int i = 0; i < N; ++i) {
+        ints[i] = std::rand() - RAND_MAX / 2;
+        longs[i] = (static_cast<std::int64_t>(std::rand()) << 20) - (std::int64_t(1) << 40);
+        unsigneds[i] = static_cast<std::uint32_t>(std::rand()) * 2654435761u;
+        shorts[i] = static_cast<short>(std::rand());
+    }
+    ints[0] = INT_MIN;
+    ints[1] = INT_MAX;
+
+    check_sort(ints, std::less<int>());
+    check_sort(ints, std::greater<int>());
+    check_sort(longs, std::less<>());
+    check_sort(unsigneds, std::less<std::uint32_t>());
+    check_sort(unsigneds, std::greater<>());
+    check_sort(shorts, std::less<short>());
+}
+
+TEST_F(RadixSortTest, FloatingPointTypes) {
+    std::vector<double> doubles(N);
+    std::vector<float> floats(N);
+    for (int i = 0; i < N; ++i) {
+        doubles[i] = (std::rand() - RAND_MAX / 2) / 1024.0;
+        floats[i] = (std::rand() % 20001 - 10000) / 8.0f;
+    }
+    doubles[0] = -0.0;
+    doubles[1] = 1e308;
+    doubles[2] = -1e308;
+
+    check_sort(doubles, std::less<double>());
+    check_sort(doubles, std::greater<double>());
+    check_sort(floats, std::less<float>());
+    check_sort(floats, std::greater<>());
+}
+
+TEST_F(RadixSortTest, StableByKey) {
+    std::vector<std::pair<std::uint32_t, int>> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = {static_cast<std::uint32_t>(std::rand() % 100), i};
+    }
+
+    radix_sort_by_key(arr.data(), arr.data() + N, [](const std::pair<std::uint32_t, int>& item) {
+        return item.first;
+    });
+
+    for (int i = 0; i < N - 1; ++i) {
+        ASSERT_LE(arr[i].first, arr[i + 1].first);
+        if (arr[i].first == arr[i + 1].first) {
+            EXPECT_LT(arr[i].second, arr[i + 1].second);
+        }
+    }
+}
+
+TEST_F(RadixSortTest, DeclinesWhenTooManyPasses) {
+    std::vector<std::uint64_t> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = (static_cast<std::uint64_t>(std::rand()) << 33) ^ static_cast<std::uint64_t>(std::rand());
+    }
+    std::vector<std::uint64_t> original = arr;
+
+    EXPECT_FALSE(radix_sort(arr.data(), arr.data() + N, std::less<std::uint64_t>(), 2));
+    EXPECT_EQ(arr, original);
+
+    EXPECT_TRUE(radix_sort(arr.data(), arr.data() + N, std::less<std::uint64_t>()));
+    EXPECT_TRUE(std::is_sorted(arr.begin(), arr.end()));
+}
+
+class ParallelSortTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    ThreadPool pool{4};
+};
+
+TEST_F(ParallelSortTest, ThreadPoolRunsAllTasks) {
+    std::atomic<int> done{0};
+    for (int i = 0; i < 1000; ++i) {
+        pool.submit([&done] { ++done; });
+    }
+
+    while (done < 1000) {
+        pool.run_pending_task();
+    }
+    EXPECT_EQ(done, 1000);
+}
+
+TEST_F(ParallelSortTest, DestructorRunsQueuedTasks) {
+    std::atomic<int> done{0};
+    for (int round = 0; round < 50; ++round) {
+        ThreadPool local(2);
+        for (int i = 0; i < 100; ++i) {
+            local.submit([&done, &local, i] {
+                ++done;
+                // Задача, поставленная во время остановки, тоже выполняется
+                if (i % 10 == 0) {
+                    local.submit([&done] { ++done; });
+                }
+            });
+        }
+    }
+    EXPECT_EQ(done, 50 * 110);
+}
+
+TEST_F(ParallelSortTest, LargeRandomArray) {
+    const int N = 1000000;
+    std::vector<int> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = std::rand();
+    }
+
+    std::vector<int> expected = arr;
+    std::sort(expected.begin(), expected.end());
+
+    parallel_sort(arr.data(), arr.data() + N, std::less<int>(), pool);
+
+    EXPECT_EQ(arr, expected);
+}
+
+TEST_F(ParallelSortTest, PoolIsReusable) {
+    const int N = 200000;
+    for (int round = 0; round < 5; ++round) {
+        std::vector<double> arr(N);
+        for (int i = 0; i < N; ++i) {
+            arr[i] = std::rand() % 1000 / 3.0;
+        }
+
+        parallel_sort(arr.data(), arr.data() + N, std::greater<double>(), pool);
+
+        EXPECT_TRUE(std::is_sorted(arr.begin(), arr.end(), std::greater<double>())) << "round " << round;
+    }
+}
+
+TEST_F(ParallelSortTest, PatternsAndDuplicates) {
+    const int N = 300000;
+    std::vector<int> sorted(N), reversed(N), same(N, 7);
+    for (int i = 0; i < N; ++i) {
+        sorted[i] = i;
+        reversed[i] = N - i;
+    }
+
+    parallel_sort(sorted.data(), sorted.data() + N, std::less<int>(), pool);
+    parallel_sort(reversed.data(), reversed.data() + N, std::less<int>(), pool);
+    parallel_sort(same.data(), same.data() + N, std::less<int>(), pool);
+
+    EXPECT_TRUE(std::is_sorted(sorted.begin(), sorted.end()));
+    EXPECT_TRUE(std::is_sorted(reversed.begin(), reversed.end()));
+    EXPECT_EQ(same, std::vector<int>(N, 7));
+}
+
+TEST_F(ParallelSortTest, StringsWithLambda) {
+    const int N = 100000;
+    std::vector<std::string> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = std::to_string(std::rand());
+    }
+
+    std::vector<std::string> expected = arr;
+    std::sort(expected.begin(), expected.end());
+
+    parallel_sort(arr.data(), arr.data() + N, [](const std::string& a, const std::string& b) {
+        return a < b;
+    }, pool);
+
+    EXPECT_EQ(arr, expected);
+}
+
+TEST_F(ParallelSortTest, ComparatorExceptionIsRethrown) {
+    const int N = 200000;
+    std::vector<int> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = std::rand();
+    }
+
+    std::atomic<int> calls{0};
+    EXPECT_THROW(parallel_sort(arr.data(), arr.data() + N, [&calls](int a, int b) {
+        if (++calls == 500000) {
+            throw std::runtime_error("comparator failed");
+        }
+        return a < b;
+    }, pool), std::runtime_error);
+}
+
+class SampleSortTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    ThreadPool pool{4};
+
+    // Размеры корзин, по которым sample_sort() разложит arr, без корзин
+    // равных элементов: наибольшая из сортируемых корзин
+    static std::size_t largest_sorted_bucket(const std::vector<int>& arr, int log_buckets) {
+        SplitterTree<int, std::less<int>> tree =
+            sample_splitters(arr.data(), arr.data() + arr.size(), std::less<int>(), log_buckets);
+        std::vector<std::size_t> sizes(tree.bucket_count(), 0);
+        for (int value : arr) {
+            ++sizes[tree.classify(value)];
+        }
+        std::size_t largest = 0;
+        for (std::size_t b = 0; b < sizes.size(); ++b) {
+            if (!tree.is_equal_bucket(b)) {
+                largest = std::max(largest, sizes[b]);
+            }
+        }
+        return largest;
+    }
+
+    // Перемещающий конструктор бросает, когда исчерпан бюджет перемещений;
+    // live считает существующие объекты
+    struct Tracked {
+        int key;
+        static std::atomic<int> live;
+        static std::atomic<long> moves_left;
+
+        explicit Tracked(int k = 0) : key(k) {
+            ++live;
+        }
+        Tracked(const Tracked& other) : key(other.key) {
+            ++live;
+        }
+        Tracked(Tracked&& other) : key(other.key) {
+            if (--moves_left == 0) {
+                throw std::runtime_error("move failed");
+            }
+            ++live;
+        }
+        Tracked& operator=(const Tracked& other) = default;
+        Tracked& operator=(Tracked&& other) = default;
+        ~Tracked() {
+            --live;
+        }
+    };
+};
+
+std::atomic<int> SampleSortTest::Tracked::live{0};
+std::atomic<long> SampleSortTest::Tracked::moves_left{0};
+
+TEST_F(SampleSortTest, SplitterTreeClassifies) {
+    std::vector<int> splitters = {10, 20, 30, 40, 50, 60, 70};
+    SplitterTree<int, std::less<int>> tree(splitters, 3, std::less<int>());
+
+    EXPECT_EQ(tree.classify(-5), 0u);
+    EXPECT_EQ(tree.classify(10), 0u);
+    EXPECT_EQ(tree.classify(11), 1u);
+    EXPECT_EQ(tree.classify(40), 3u);
+    EXPECT_EQ(tree.classify(41), 4u);
+    EXPECT_EQ(tree.classify(70), 6u);
+    EXPECT_EQ(tree.classify(1000), 7u);
+}
+
+TEST_F(SampleSortTest, LargeRandomArray) {
+    const int N = 1000000;
+    std::vector<int> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = std::rand();
+    }
+
+    std::vector<int> expected = arr;
+    std::sort(expected.begin(), expected.end());
+
+    sample_sort(arr.data(), arr.data() + N, std::less<int>(), pool);
+
+    EXPECT_EQ(arr, expected);
+}
+
+TEST_F(SampleSortTest, FewDistinctKeys) {
+    const int N = 500000;
+    std::vector<long long> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = std::rand() % 3;
+    }
+
+    std::vector<long long> expected = arr;
+    std::sort(expected.begin(), expected.end(), std::greater<long long>());
+
+    sample_sort(arr.data(), arr.data() + N, std::greater<long long>(), pool);
+
+    EXPECT_EQ(arr, expected);
+}
+
+TEST_F(SampleSortTest, Strings) {
+    const int N = 200000;
+    std::vector<std::string> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = "key" + std::to_string(std::rand() % 50000);
+    }
+
+    std::vector<std::string> expected = arr;
+    std::sort(expected.begin(), expected.end());
+
+    sample_sort(arr.data(), arr.data() + N, std::less<std::string>(), pool);
+
+    EXPECT_EQ(arr, expected);
+}
+
+TEST_F(SampleSortTest, EqualBucketsKeepBalance) {
+    const int N = 1 << 18;
+    const int LOG_BUCKETS = 6;
+
+    std::vector<int> all_equal(N, 7);
+    std::vector<int> few_distinct(N);
+    std::vector<int> skewed(N);
+    for (int i = 0; i < N; ++i) {
+        few_distinct[i] = std::rand() % 5;
+        skewed[i] = i % 2 ? 42 : std::rand();
+    }
+
+    // Частые значения уходят в корзины равных, а не в одну огромную
+    EXPECT_EQ(largest_sorted_bucket(all_equal, LOG_BUCKETS), 0u);
+    EXPECT_EQ(largest_sorted_bucket(few_distinct, LOG_BUCKETS), 0u);
+    EXPECT_LE(largest_sorted_bucket(skewed, LOG_BUCKETS), std::size_t(N / 16));
+
+    for (std::vector<int>* arr : {&all_equal, &few_distinct, &skewed}) {
+        std::vector<int> expected = *arr;
+        std::sort(expected.begin(), expected.end());
+        sample_sort(arr->data(), arr->data() + N, std::less<int>(), pool);
+        EXPECT_EQ(*arr, expected);
+    }
+}
+
+TEST_F(SampleSortTest, ExceptionsDoNotLeak) {
+    const int N = 200000;
+    std::vector<Tracked> arr;
+    arr.reserve(N);
+    for (int i = 0; i < N; ++i) {
+        arr.emplace_back(std::rand());
+    }
+    ASSERT_EQ(Tracked::live, N);
+
+    auto less = [](const Tracked& a, const Tracked& b) {
+        return a.key < b.key;
+    };
+
+    // Перемещение падает посреди раскладки в буфер
+    Tracked::moves_left = N / 2;
+    EXPECT_THROW(sample_sort(arr.data(), arr.data() + N, less, pool), std::runtime_error);
+    EXPECT_EQ(Tracked::live, N);
+
+    // Компаратор падает при сортировке корзин, когда часть из них
+    // ещё в буфере
+    Tracked::moves_left = 0;
+    std::atomic<long> calls{0};
+    EXPECT_THROW(sample_sort(arr.data(), arr.data() + N, [&](const Tracked& a, const Tracked& b) {
+        if (++calls == 8L * N) {
+            throw std::runtime_error("comparator failed");
+        }
+        return a.key < b.key;
+    }, pool), std::runtime_error);
+    EXPECT_EQ(Tracked::live, N);
+}
+
+TEST_F(SampleSortTest, SmallArrayFallsBack) {
+    std::vector<int> arr = {5, 2, 8, 1, 9, 3};
+    sample_sort(arr.data(), arr.data() + arr.size(), std::less<int>(), pool);
+    EXPECT_EQ(arr, (std::vector<int>{1, 2, 3, 5, 8, 9}));
+}
+
+class SimdPartitionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    // Проверяет ядро каждого доступного уровня на всех размерах от двух
+    // векторов, чтобы задеть все остатки короче вектора
+    template <typename T, bool Descending>
+    static void check_kernels() {
+        std::vector<SimdLevel> levels;
+        if (cpu_has_avx2()) {
+            levels.push_back(SimdLevel::avx2);
+        }
+        if (cpu_has_avx512()) {
+            levels.push_back(SimdLevel::avx512);
+        }
+
+        for (SimdLevel level : levels) {
+            SimdPartitionKernel<T> kernel = simd_partition_kernel<T, Descending>(level);
+            ASSERT_NE(kernel, nullptr);
+
+            for (int n = 32; n < 200; ++n) {
+                std::vector<T> arr(n);
+                for (int i = 0; i < n; ++i) {
+                    arr[i] = static_cast<T>(std::rand() % 41 - 20);
+                }
+                std::vector<T> expected = arr;
+                std::sort(expected.begin(), expected.end());
+
+                T pivot = static_cast<T>(std::rand() % 41 - 20);
+                T *p = kernel(arr.data(), arr.data() + n, pivot);
+                for (T *q = arr.data(); q != p; ++q) {
+                    EXPECT_TRUE(Descending ? pivot < *q : *q < pivot) << "size " << n;
+                }
+                for (T *q = p; q != arr.data() + n; ++q) {
+                    EXPECT_FALSE(Descending ? pivot < *q : *q < pivot) << "size " << n;
+                }
+
+                std::sort(arr.begin(), arr.end());
+                EXPECT_EQ(arr, expected) << "size " << n;
+            }
+        }
+    }
+
+    template <typename T, typename Compare>
+    static void check_sort(int n, Compare comp) {
+        std::vector<T> arr(n);
+        for (int i = 0; i < n; ++i) {
+            arr[i] = static_cast<T>(std::rand() - RAND_MAX / 2) / 3;
+        }
+        std::vector<T> expected = arr;
+        std::sort(expected.begin(), expected.end(), comp);
+
+        quicksort(arr.data(), arr.data() + n, comp);
+
+        EXPECT_EQ(arr, expected) << "size " << n;
+    }
+};
+
+TEST_F(SimdPartitionTest, KernelsAllTypes) {
+    check_kernels<int, false>();
+    check_kernels<int, true>();
+    check_kernels<long long, false>();
+    check_kernels<std::int64_t, true>();
+    check_kernels<float, false>();
+    check_kernels<float, true>();
+    check_kernels<double, false>();
+    check_kernels<double, true>();
+}
+
+TEST_F(SimdPartitionTest, PartitionContract) {
+    const int sizes[] = {2, 3, 17, 31, 32, 33, 100, 1000};
+
+    for (int n : sizes) {
+        std::vector<double> arr(n);
+        for (int i = 0; i < n; ++i) {
+            arr[i] = std::rand() % 50;
+        }
+        std::vector<double> expected = arr;
+        std::sort(expected.begin(), expected.end());
+
+        double *p = simd_partition(arr.data(), arr.data() + n, &arr[n / 2], std::less<double>()).first;
+        for (double *q = arr.data(); q != p; ++q) {
+            EXPECT_LT(*q, *p) << "size " << n;
+        }
+        for (double *q = p + 1; q != arr.data() + n; ++q) {
+            EXPECT_GE(*q, *p) << "size " << n;
+        }
+
+        std::sort(arr.begin(), arr.end());
+        EXPECT_EQ(arr, expected) << "size " << n;
+    }
+
+    std::vector<int> sorted(1000);
+    for (int i = 0; i < 1000; ++i) {
+        sorted[i] = i;
+    }
+    std::pair<int *, bool> part = simd_partition(sorted.data(), sorted.data() + 1000, &sorted[500], std::less<int>());
+    EXPECT_TRUE(part.second);
+    EXPECT_EQ(*part.first, 500);
+}
+
+TEST_F(SimdPartitionTest, QuickSortUsesKernel) {
+    const int sizes[] = {100, 1000, 100000};
+
+    for (int n : sizes) {
+        check_sort<int>(n, std::less<int>());
+        check_sort<long long>(n, std::greater<long long>());
+        check_sort<float>(n, std::greater<>());
+        check_sort<double>(n, std::less<>());
+    }
+}
+
+class SortingNetworkTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+};
+
+// Принцип нулей и единиц: сеть сортирует любые входы, если сортирует
+// все последовательности из нулей и единиц
+TEST_F(SortingNetworkTest, ZeroOnePrinciple) {
+    for (int n = 2; n <= static_cast<int>(SORTING_NETWORK_MAX_SIZE); ++n) {
+        for (int bits = 0; bits < (1 << n); ++bits) {
+            int arr[SORTING_NETWORK_MAX_SIZE];
+            for (int i = 0; i < n; ++i) {
+                arr[i] = (bits >> i) & 1;
+            }
+
+            sorting_network_sort(arr, arr + n, std::less<int>());
+
+            ASSERT_TRUE(std::is_sorted(arr, arr + n)) << "size " << n << ", input " << bits;
+        }
+    }
+}
+
+TEST_F(SortingNetworkTest, RandomInputsAllTypes) {
+    for (int n = 0; n <= static_cast<int>(SORTING_NETWORK_MAX_SIZE); ++n) {
+        for (int trial = 0; trial < 100; ++trial) {
+            std::vector<long long> ints(n);
+            std::vector<double> doubles(n);
+            for (int i = 0; i < n; ++i) {
+                ints[i] = std::rand() % 10 - 5;
+                doubles[i] = (std::rand() % 1000) / 7.0;
+            }
+            std::vector<long long> expected_ints = ints;
+            std::sort(expected_ints.begin(), expected_ints.end(), std::greater<long long>());
+            std::vector<double> expected_doubles = doubles;
+            std::sort(expected_doubles.begin(), expected_doubles.end());
+
+            sorting_network_sort(ints.data(), ints.data() + n, std::greater<long long>());
+            sorting_network_sort(doubles.data(), doubles.data() + n, std::less<>());
+
+            EXPECT_EQ(ints, expected_ints) << "size " << n;
+            EXPECT_EQ(doubles, expected_doubles) << "size " << n;
+        }
+    }
+}
+
+TEST_F(SortingNetworkTest, KeepsSignedZeros) {
+    float arr[] = {0.0f, -0.0f, 1.0f, -0.0f, 0.0f, -1.0f};
+    sorting_network_sort(arr, arr + 6, std::less<float>());
+
+    int negative_zeros = 0;
+    for (float x : arr) {
+        if (x == 0.0f && std::signbit(x)) {
+            ++negative_zeros;
+        }
+    }
+    EXPECT_EQ(arr[0], -1.0f);
+    EXPECT_EQ(arr[5], 1.0f);
+    EXPECT_EQ(negative_zeros, 2);
+}
+
+class StableSortTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    struct Record {
+        int key;
+        int order;
+    };
+
+    static bool by_key(const Record& a, const Record& b) {
+        return a.key < b.key;
+    }
+
+    // Устойчивый порядок — порядок по паре (ключ, исходная позиция)
+    static void check_stable(std::vector<Record> arr, std::ptrdiff_t buffer_size) {
+        std::vector<std::pair<int, int>> expected;
+        for (const Record& r : arr) {
+            expected.emplace_back(r.key, r.order);
+        }
+        std::sort(expected.begin(), expected.end());
+
+        if (buffer_size < 0) {
+            stable_sort(arr.data(), arr.data() + arr.size(), by_key);
+        } else {
+            std::vector<Record> buffer(buffer_size);
+            stable_sort(arr.data(), arr.data() + arr.size(), by_key, buffer.data(), buffer_size);
+        }
+
+        ASSERT_EQ(arr.size(), expected.size());
+        for (size_t i = 0; i < arr.size(); ++i) {
+            EXPECT_EQ(arr[i].key, expected[i].first) << "index " << i;
+            EXPECT_EQ(arr[i].order, expected[i].second) << "index " << i;
+        }
+    }
+
+    static std::vector<Record> make_records(int n, int distinct) {
+        std::vector<Record> arr(n);
+        for (int i = 0; i < n; ++i) {
+            arr[i] = {std::rand() % distinct, i};
+        }
+        return arr;
+    }
+};
+
+TEST_F(StableSortTest, KeepsEqualKeysInOrder) {
+    const int sizes[] = {0, 1, 2, 31, 32, 33, 64, 1000, 100000};
+
+    for (int n : sizes) {
+        check_stable(make_records(n, 10), -1);
+        check_stable(make_records(n, n + 1), -1);
+    }
+}
+
+TEST_F(StableSortTest, CallerBufferAndInPlaceMerge) {
+    const int N = 20000;
+    const std::ptrdiff_t buffer_sizes[] = {0, 1, 100, N / 4, N / 2};
+
+    for (std::ptrdiff_t size : buffer_sizes) {
+        check_stable(make_records(N, 50), size);
+    }
+}
+
+TEST_F(StableSortTest, DescendingRunsAreReversedStably) {
+    const int N = 10000;
+    std::vector<Record> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = {(N - i) / 3, i};
+    }
+    check_stable(arr, -1);
+    check_stable(arr, 0);
+}
+
+TEST_F(StableSortTest, PartiallyOrderedIsNearLinear) {
+    const int N = 100000;
+    std::vector<int> sorted(N);
+    for (int i = 0; i < N; ++i) {
+        sorted[i] = i;
+    }
+
+    long long comparisons = 0;
+    auto counting_less = [&comparisons](int a, int b) {
+        ++comparisons;
+        return a < b;
+    };
+
+    std::vector<int> arr = sorted;
+    stable_sort(arr.data(), arr.data() + N, counting_less);
+    EXPECT_EQ(arr, sorted);
+    EXPECT_EQ(comparisons, N - 1);
+
+    // Две чередующиеся отсортированные половины сливаются галопом
+    arr.clear();
+    for (int i = 0; i < N / 2; ++i) {
+        arr.push_back(2 * i + N);
+    }
+    for (int i = 0; i < N / 2; ++i) {
+        arr.push_back(i < N / 4 ? i : 2 * N + i);
+    }
+    std::vector<int> expected = arr;
+    std::sort(expected.begin(), expected.end());
+
+    comparisons = 0;
+    stable_sort(arr.data(), arr.data() + N, counting_less);
+    EXPECT_EQ(arr, expected);
+    EXPECT_LE(comparisons, 2LL * N);
+}
+
+TEST_F(StableSortTest, StringsAndNoDefaultConstructor) {
+    struct Named {
+        std::string name;
+        int rank;
+        explicit Named(std::string n, int r) : name(std::move(n)), rank(r) {}
+    };
+
+    std::vector<Named> arr;
+    std::vector<std::pair<int, int>> expected;
+    for (int i = 0; i < 500; ++i) {
+        arr.emplace_back("item" + std::to_string(i), std::rand() % 7);
+        expected.emplace_back(arr.back().rank, i);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    stable_sort(arr.data(), arr.data() + arr.size(), [](const Named& a, const Named& b) {
+        return a.rank < b.rank;
+    });
+
+    for (size_t i = 0; i < arr.size(); ++i) {
+        EXPECT_EQ(arr[i].name, "item" + std::to_string(expected[i].second));
+    }
+}
+
+class SelectionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    static std::vector<int> make_random(int n, int range) {
+        std::vector<int> arr(n);
+        for (int i = 0; i < n; ++i) {
+            arr[i] = std::rand() % range;
+        }
+        return arr;
+    }
+};
+
+TEST_F(SelectionTest, NthElementPartitionsAroundNth) {
+    const int sizes[] = {1, 2, 15, 17, 1000, 100000};
+    const int ranges[] = {3, 1000000};
+
+    for (int n : sizes) {
+        for (int range : ranges) {
+            std::vector<int> arr = make_random(n, range);
+            std::vector<int> sorted = arr;
+            std::sort(sorted.begin(), sorted.end());
+
+            int positions[] = {0, n / 3, n / 2, n - 1};
+            for (int k : positions) {
+                std::vector<int> work = arr;
+                nth_element(work.data(), work.data() + k, work.data() + n, std::less<int>());
+
+                ASSERT_EQ(work[k], sorted[k]) << "size " << n << ", k " << k;
+                for (int i = 0; i < k; ++i) {
+                    EXPECT_LE(work[i], work[k]);
+                }
+                for (int i = k + 1; i < n; ++i) {
+                    EXPECT_GE(work[i], work[k]);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(SelectionTest, NthElementSurvivesAdversary) {
+    const int N = 20000;
+    std::vector<int> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = i % 2 == 0 ? i : N - i;
+    }
+
+    long long comparisons = 0;
+    nth_element(arr.data(), arr.data() + N / 2, arr.data() + N, [&comparisons](int a, int b) {
+        ++comparisons;
+        return a < b;
+    });
+
+    std::vector<int> sorted = arr;
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(arr[N / 2], sorted[N / 2]);
+    EXPECT_LE(comparisons, 2LL * N * floor_log2(N));
+}
+
+TEST_F(SelectionTest, PartialSortSmallAndLargeK) {
+    const int N = 100000;
+    const int ks[] = {0, 1, 10, N / SELECTION_HEAP_RATIO, N / SELECTION_HEAP_RATIO + 1, N / 2, N};
+
+    std::vector<int> arr = make_random(N, 1000);
+    std::vector<int> sorted = arr;
+    std::sort(sorted.begin(), sorted.end());
+
+    for (int k : ks) {
+        std::vector<int> work = arr;
+        partial_sort(work.data(), work.data() + k, work.data() + N, std::greater<int>());
+
+        for (int i = 0; i < k; ++i) {
+            ASSERT_EQ(work[i], sorted[N - 1 - i]) << "k " << k;
+        }
+    }
+}
+
+TEST_F(SelectionTest, TopKLeavesInputUntouched) {
+    const int N = 50000;
+    std::vector<std::string> arr(N);
+    for (int i = 0; i < N; ++i) {
+        arr[i] = std::to_string(std::rand());
+    }
+    const std::vector<std::string> original = arr;
+    std::vector<std::string> sorted = arr;
+    std::sort(sorted.begin(), sorted.end());
+
+    const int ks[] = {0, 1, 100, N / 2, N + 10};
+    for (int k : ks) {
+        std::vector<std::string> top = top_k(arr.data(), arr.data() + N, k, std::less<std::string>());
+
+        int expected_size = k < N ? k : N;
+        ASSERT_EQ(static_cast<int>(top.size()), expected_size);
+        EXPECT_TRUE(std::equal(top.begin(), top.end(), sorted.begin())) << "k " << k;
+    }
+    EXPECT_EQ(arr, original);
+}
+
+class ExternalSortTest : public ::testing::Test {
+protected:
+    struct Record {
+        std::uint64_t key;
+        std::uint32_t id;
+        std::uint32_t padding;
+    };
+
+    std::filesystem::path dir;
+
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+        dir = std::filesystem::temp_directory_path() /
+              ("external_sort_test_" + std::to_string(std::rand()));
+        std::filesystem::create_directories(dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir);
+    }
+
+    static bool by_key(const Record& a, const Record& b) {
+        return a.key < b.key;
+    }
+
+    template <typename T>
+    static void write_file(const std::filesystem::path& path, const std::vector<T>& data) {
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(T));
+    }
+
+    template <typename T>
+    static std::vector<T> read_file(const std::filesystem::path& path) {
+        std::vector<T> data(std::filesystem::file_size(path) / sizeof(T));
+        std::ifstream in(path, std::ios::binary);
+        in.read(reinterpret_cast<char*>(data.data()), data.size() * sizeof(T));
+        return data;
+    }
+
+    void check_records(int n, std::size_t budget) {
+        std::vector<Record> records(n);
+        std::vector<std::pair<std::uint64_t, std::uint32_t>> expected;
+        for (int i = 0; i < n; ++i) {
+            records[i] = {static_cast<std::uint64_t>(std::rand() % 100000), static_cast<std::uint32_t>(i), 0};
+            expected.emplace_back(records[i].key, records[i].id);
+        }
+        std::sort(expected.begin(), expected.end());
+        write_file(dir / "input.bin", records);
+
+        ExternalSortConfig config;
+        config.memory_budget = budget;
+        config.temp_directory = dir.string();
+        external_sort<Record>((dir / "input.bin").string(), (dir / "output.bin").string(), by_key, config);
+
+        std::vector<Record> result = read_file<Record>(dir / "output.bin");
+        ASSERT_EQ(result.size(), expected.size());
+        std::vector<std::pair<std::uint64_t, std::uint32_t>> actual;
+        for (int i = 0; i < n; ++i) {
+            ASSERT_EQ(result[i].key, expected[i].first) << "index " << i;
+            actual.emplace_back(result[i].key, result[i].id);
+        }
+        std::sort(actual.begin(), actual.end());
+        EXPECT_EQ(actual, expected);
+
+        // Временные серии удалены, остались только вход и выход
+        int files = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            (void)entry;
+            ++files;
+        }
+        EXPECT_EQ(files, 2);
+    }
+};
+
+TEST_F(ExternalSortTest, FitsInMemory) {
+    check_records(1000, 1 << 20);
+    check_records(0, 1 << 20);
+}
+
+TEST_F(ExternalSortTest, ManyRunsSinglePass) {
+    check_records(200000, 4 << 20);
+}
+
+TEST_F(ExternalSortTest, MultiPassMerge) {
+    // Бюджет меньше блока чтения: сливается по две серии за проход
+    check_records(100000, 64 << 10);
+}
+
+TEST_F(ExternalSortTest, ArithmeticKeys) {
+    const int N = 300000;
+    std::vector<double> data(N);
+    for (int i = 0; i < N; ++i) {
+        data[i] = (std::rand() % 2000001 - 1000000) / 3.0;
+    }
+    write_file(dir / "input.bin", data);
+
+    ExternalSortConfig config;
+    config.memory_budget = 512 << 10;
+    config.temp_directory = dir.string();
+    external_sort<double>((dir / "input.bin").string(), (dir / "output.bin").string(),
+                          std::greater<double>(), config);
+
+    std::sort(data.begin(), data.end(), std::greater<double>());
+    EXPECT_EQ(read_file<double>(dir / "output.bin"), data);
+}
+
+TEST_F(ExternalSortTest, ConcurrentJobsShareTempDirectory) {
+    // Серии разных сортировок в общем каталоге получают разные файлы
+    ExternalRunFile a = create_external_run_file(ExternalSortConfig{1 << 20, dir.string()});
+    ExternalRunFile b = create_external_run_file(ExternalSortConfig{1 << 20, dir.string()});
+    EXPECT_NE(a.path(), b.path());
+    EXPECT_TRUE(std::filesystem::exists(a.path()));
+    EXPECT_TRUE(std::filesystem::exists(b.path()));
+
+    const int JOBS = 4;
+    const int N = 50000;
+    std::vector<std::vector<double>> inputs(JOBS, std::vector<double>(N));
+    for (int job = 0; job < JOBS; ++job) {
+        for (int i = 0; i < N; ++i) {
+            inputs[job][i] = std::rand() % 1000000 + job;
+        }
+        write_file(dir / ("input" + std::to_string(job) + ".bin"), inputs[job]);
+    }
+
+    std::vector<std::thread> threads;
+    for (int job = 0; job < JOBS; ++job) {
+        threads.emplace_back([this, job] {
+            ExternalSortConfig config;
+            config.memory_budget = 64 << 10;
+            config.temp_directory = dir.string();
+            std::string name = std::to_string(job) + ".bin";
+            external_sort<double>((dir / ("input" + name)).string(), (dir / ("output" + name)).string(),
+                                  std::less<double>(), config);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (int job = 0; job < JOBS; ++job) {
+        std::sort(inputs[job].begin(), inputs[job].end());
+        EXPECT_EQ(read_file<double>(dir / ("output" + std::to_string(job) + ".bin")), inputs[job]);
+    }
+}
+
+TEST_F(ExternalSortTest, ReportsIoErrors) {
+    ExternalSortConfig config;
+    config.temp_directory = dir.string();
+
+    EXPECT_THROW(external_sort<Record>((dir / "missing.bin").string(), (dir / "output.bin").string(),
+                                       by_key, config),
+                 std::runtime_error);
+
+    write_file(dir / "truncated.bin", std::vector<char>(sizeof(Record) + 3));
+    EXPECT_THROW(external_sort<Record>((dir / "truncated.bin").string(), (dir / "output.bin").string(),
+                                       by_key, config),
+                 std::runtime_error);
+
+    std::vector<Record> records(1000, Record{1, 2, 3});
+    write_file(dir / "input.bin", records);
+    config.memory_budget = 1 << 12;
+    EXPECT_THROW(external_sort<Record>((dir / "input.bin").string(), (dir / "no_such_dir" / "out.bin").string(),
+                                       by_key, config),
+                 std::runtime_error);
+}
+
+class KeySortTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    struct Person {
+        std::string name;
+        int age;
+        int order;
+    };
+
+    static std::string lowercase(const std::string& s) {
+        std::string result = s;
+        for (char& c : result) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return result;
+    }
+};
+
+TEST_F(KeySortTest, KeyComputedOncePerElement) {
+    const int N = 5000;
+    std::vector<Person> people(N);
+    for (int i = 0; i < N; ++i) {
+        people[i].name = std::string(1, static_cast<char>((std::rand() % 2 ? 'a' : 'A') + std::rand() % 26)) +
+                         std::to_string(std::rand() % 100);
+        people[i].order = i;
+    }
+
+    int calls = 0;
+    sort_by_key(people.data(), people.data() + N, [&calls](const Person& p) {
+        ++calls;
+        return lowercase(p.name);
+    });
+
+    EXPECT_EQ(calls, N);
+    for (int i = 0; i + 1 < N; ++i) {
+        std::string a = lowercase(people[i].name);
+        std::string b = lowercase(people[i + 1].name);
+        ASSERT_LE(a, b);
+        if (a == b) {
+            EXPECT_LT(people[i].order, people[i + 1].order) << "equal keys must keep input order";
+        }
+    }
+}
+
+TEST_F(KeySortTest, IntegralKeysUseStableRadix) {
+    const int sizes[] = {10, 100000};
+
+    for (int n : sizes) {
+        std::vector<Person> people(n);
+        std::vector<std::pair<int, int>> expected;
+        for (int i = 0; i < n; ++i) {
+            people[i].age = std::rand() % 100;
+            people[i].order = i;
+            expected.emplace_back(-people[i].age, i);
+        }
+        std::sort(expected.begin(), expected.end());
+
+        sort_by_key(people.data(), people.data() + n, [](const Person& p) { return p.age; }, std::greater<int>());
+
+        for (int i = 0; i < n; ++i) {
+            ASSERT_EQ(people[i].age, -expected[i].first) << "size " << n;
+            ASSERT_EQ(people[i].order, expected[i].second) << "size " << n;
+        }
+    }
+}
+
+TEST_F(KeySortTest, FloatingKeys) {
+    const int N = 10000;
+    std::vector<double> values(N);
+    for (int i = 0; i < N; ++i) {
+        values[i] = (std::rand() % 20001 - 10000) / 8.0;
+    }
+    std::vector<double> expected = values;
+    std::sort(expected.begin(), expected.end(), [](double a, double b) { return std::fabs(a) < std::fabs(b); });
+
+    sort_by_key(values.data(), values.data() + N, [](double x) { return std::fabs(x); });
+
+    for (int i = 0; i < N; ++i) {
+        EXPECT_EQ(std::fabs(values[i]), std::fabs(expected[i]));
+    }
+}
+
+TEST_F(KeySortTest, OverAlignedRecords) {
+    // Запись с выравниванием по строке кэша помнит, создавалась ли она
+    // по невыровненному адресу
+    struct alignas(64) Aligned {
+        int key = 0;
+        bool misaligned = false;
+
+        Aligned() = default;
+        explicit Aligned(int k) : key(k) {}
+        Aligned(Aligned&& other) noexcept : key(other.key) {
+            misaligned = other.misaligned || reinterpret_cast<std::uintptr_t>(this) % 64 != 0;
+        }
+        Aligned& operator=(Aligned&& other) noexcept {
+            key = other.key;
+            misaligned = other.misaligned;
+            return *this;
+        }
+    };
+
+    const int N = 5000;
+    std::vector<Aligned> records;
+    records.reserve(N);
+    for (int i = 0; i < N; ++i) {
+        records.emplace_back(std::rand() % 1000);
+    }
+
+    sort_by_key(records.data(), records.data() + N, [](const Aligned& r) { return r.key; });
+
+    for (int i = 0; i < N; ++i) {
+        ASSERT_FALSE(records[i].misaligned) << "index " << i;
+        if (i + 1 < N) {
+            ASSERT_LE(records[i].key, records[i + 1].key);
+        }
+    }
+}
+
+TEST_F(KeySortTest, ApplyPermutationInPlace) {
+    const int N = 1000;
+    std::vector<int> order(N);
+    for (int i = 0; i < N; ++i) {
+        order[i] = i;
+    }
+    for (int i = N - 1; i > 0; --i) {
+        std::swap(order[i], order[std::rand() % (i + 1)]);
+    }
+
+    std::vector<std::string> data(N);
+    for (int i = 0; i < N; ++i) {
+        data[i] = "value" + std::to_string(i);
+    }
+
+    std::vector<int> order_copy = order;
+    std::vector<std::string> buffered = data;
+    apply_permutation(data.data(), order.data(), N);
+    apply_permutation_buffered(buffered.data(), order_copy.data(), N);
+
+    // Буферный вариант не портит order
+    for (int i = 0; i < N; ++i) {
+        EXPECT_EQ(data[i], "value" + std::to_string(order_copy[i]));
+        EXPECT_EQ(buffered[i], data[i]);
+    }
+}
+
+class IndirectSortTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    struct BigRecord {
+        int key;
+        char payload[INDIRECT_SORT_MIN_BYTES];
+    };
+
+    // Тип без перемещения: каждое перемещение — подсчитываемая копия
+    struct Counted {
+        int key;
+        static int copies;
+
+        explicit Counted(int k = 0) : key(k) {}
+        Counted(const Counted& other) : key(other.key) {
+            ++copies;
+        }
+        Counted& operator=(const Counted& other) {
+            key = other.key;
+            ++copies;
+            return *this;
+        }
+    };
+};
+
+int IndirectSortTest::Counted::copies = 0;
+
+TEST_F(IndirectSortTest, ArgsortOrdersIndices) {
+    const int N = 10000;
+    std::vector<double> values(N);
+    for (int i = 0; i < N; ++i) {
+        values[i] = std::rand() % 1000 / 3.0;
+    }
+    const std::vector<double> original = values;
+
+    std::vector<std::uint32_t> order = argsort(values.data(), values.data() + N, std::less<double>());
+    std::vector<std::uint64_t> wide = argsort<std::uint64_t>(values.data(), values.data() + N, std::greater<>());
+
+    EXPECT_EQ(values, original);
+    ASSERT_EQ(static_cast<int>(order.size()), N);
+    for (int i = 0; i + 1 < N; ++i) {
+        EXPECT_LE(values[order[i]], values[order[i + 1]]);
+        EXPECT_GE(values[wide[i]], values[wide[i + 1]]);
+    }
+
+    std::vector<std::uint32_t> seen = order;
+    std::sort(seen.begin(), seen.end());
+    for (int i = 0; i < N; ++i) {
+        ASSERT_EQ(seen[i], static_cast<std::uint32_t>(i));
+    }
+}
+
+TEST_F(IndirectSortTest, NarrowIndexThrows) {
+    std::vector<int> values(300);
+    EXPECT_THROW(argsort<std::uint8_t>(values.data(), values.data() + values.size(), std::less<int>()),
+                 std::length_error);
+    EXPECT_NO_THROW(argsort<std::uint8_t>(values.data(), values.data() + 256, std::less<int>()));
+}
+
+TEST_F(IndirectSortTest, LargeRecordsSortedIndirectly) {
+    static_assert(use_indirect_sort<BigRecord>, "big records must take the indirect path");
+    static_assert(!use_indirect_sort<std::string>, "strings move cheaply");
+
+    const int N = 2000;
+    std::vector<BigRecord> records(N);
+    for (int i = 0; i < N; ++i) {
+        records[i].key = std::rand() % 500;
+        std::fill(std::begin(records[i].payload), std::end(records[i].payload), static_cast<char>(records[i].key));
+    }
+
+    sort(records.data(), records.data() + N, [](const BigRecord& a, const BigRecord& b) {
+        return a.key < b.key;
+    });
+
+    for (int i = 0; i < N; ++i) {
+        if (i + 1 < N) {
+            ASSERT_LE(records[i].key, records[i + 1].key);
+        }
+        EXPECT_EQ(records[i].payload[INDIRECT_SORT_MIN_BYTES - 1], static_cast<char>(records[i].key));
+    }
+}
+
+TEST_F(IndirectSortTest, CopyOnlyTypeMovedOncePerElement) {
+    static_assert(use_indirect_sort<Counted>, "copy-only types must take the indirect path");
+
+    const int N = 10000;
+    std::vector<Counted> values;
+    values.reserve(N);
+    for (int i = 0; i < N; ++i) {
+        values.emplace_back(std::rand());
+    }
+
+    Counted::copies = 0;
+    sort(values.data(), values.data() + N, [](const Counted& a, const Counted& b) {
+        return a.key < b.key;
+    });
+
+    for (int i = 0; i + 1 < N; ++i) {
+        ASSERT_LE(values[i].key, values[i + 1].key);
+    }
+    // Каждый элемент копируется один раз, плюс по две копии на цикл перестановки
+    EXPECT_LE(Counted::copies, 2 * N);
+}
+
+class ZipSortTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+};
+
+TEST_F(ZipSortTest, ColumnsFollowKeys) {
+    const int N = 20000;
+    std::vector<int> keys(N);
+    std::vector<std::string> names(N);
+    std::vector<double> weights(N);
+    for (int i = 0; i < N; ++i) {
+        keys[i] = std::rand() % 1000;
+        names[i] = "row" + std::to_string(keys[i]);
+        weights[i] = keys[i] * 0.5;
+    }
+
+    sort_zip(keys.data(), keys.data() + N, std::less<int>(), names.data(), weights.data());
+
+    for (int i = 0; i < N; ++i) {
+        if (i + 1 < N) {
+            ASSERT_LE(keys[i], keys[i + 1]);
+        }
+        ASSERT_EQ(names[i], "row" + std::to_string(keys[i]));
+        ASSERT_EQ(weights[i], keys[i] * 0.5);
+    }
+}
+
+TEST_F(ZipSortTest, RowsArePermutedNotDuplicated) {
+    const int N = 5000;
+    std::vector<double> keys(N);
+    std::vector<int> rows(N);
+    for (int i = 0; i < N; ++i) {
+        keys[i] = std::rand() % 10;
+        rows[i] = i;
+    }
+    const std::vector<double> original = keys;
+
+    sort_zip(keys.data(), keys.data() + N, std::greater<double>(), rows.data());
+
+    std::vector<bool> seen(N, false);
+    for (int i = 0; i < N; ++i) {
+        if (i + 1 < N) {
+            ASSERT_GE(keys[i], keys[i + 1]);
+        }
+        ASSERT_FALSE(seen[rows[i]]);
+        seen[rows[i]] = true;
+        ASSERT_EQ(keys[i], original[rows[i]]);
+    }
+}
+
+TEST_F(ZipSortTest, KeysOnlyAndPatterns) {
+    const int N = 10000;
+    std::vector<int> sorted(N), reversed(N), equal(N, 7), organ(N);
+    for (int i = 0; i < N; ++i) {
+        sorted[i] = i;
+        reversed[i] = N - i;
+        organ[i] = i < N / 2 ? i : N - i;
+    }
+
+    for (std::vector<int>* keys : {&sorted, &reversed, &equal, &organ}) {
+        std::vector<int> index(N);
+        for (int i = 0; i < N; ++i) {
+            index[i] = (*keys)[i];
+        }
+        std::vector<int> expected = *keys;
+        std::sort(expected.begin(), expected.end());
+
+        sort_zip(keys->data(), keys->data() + N, std::less<int>());
+        EXPECT_EQ(*keys, expected);
+
+        sort_zip(index.data(), index.data() + N, std::less<int>(), keys->data());
+        EXPECT_EQ(index, expected);
+    }
+
+    int single = 1;
+    sort_zip(&single, &single + 1, std::less<int>());
+    EXPECT_EQ(single, 1);
+}
+
+class StringSortTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    // Строки из малого алфавита с длинными общими префиксами, нулевыми
+    // и старшими байтами, строки-префиксы друг друга
+    static std::vector<std::string> make_strings(int n) {
+        const char alphabet[] = {'a', 'b', '\0', '\xff', '\x80'};
+        std::vector<std::string> result;
+        result.reserve(n);
+        for (int i = 0; i < n; ++i) {
+            std::string s = std::rand() % 2 ? "https://example.com/path/" : "";
+            int length = std::rand() % 20;
+            for (int k = 0; k < length; ++k) {
+                s += alphabet[std::rand() % 5];
+            }
+            result.push_back(s);
+        }
+        return result;
+    }
+};
+
+TEST_F(StringSortTest, MatchesStandardOrder) {
+    std::vector<std::string> values = make_strings(20000);
+    std::vector<std::string> expected = values;
+    std::sort(expected.begin(), expected.end());
+
+    sort(values.data(), values.data() + values.size(), std::less<std::string>());
+    EXPECT_EQ(values, expected);
+
+    std::reverse(expected.begin(), expected.end());
+    sort(values.data(), values.data() + values.size(), std::greater<>());
+    EXPECT_EQ(values, expected);
+}
+
+TEST_F(StringSortTest, WordBoundaries) {
+    // Длины около границ слова ключа и строки, отличающиеся лишь
+    // завершающим нулевым байтом
+    std::vector<std::string> values;
+    for (int length = 0; length <= 22; ++length) {
+        values.push_back(std::string(length, 'x'));
+        values.push_back(std::string(length, 'x') + '\0');
+        values.push_back(std::string(length, 'x') + 'y');
+        values.push_back(std::string(length, '\0'));
+    }
+    std::vector<std::string> expected = values;
+    std::sort(expected.begin(), expected.end());
+
+    std::reverse(values.begin(), values.end());
+    sort(values.data(), values.data() + values.size(), std::less<std::string>());
+    EXPECT_EQ(values, expected);
+}
+
+TEST_F(StringSortTest, StringViews) {
+    std::vector<std::string> storage = make_strings(5000);
+    std::vector<std::string_view> views(storage.begin(), storage.end());
+    std::vector<std::string_view> expected = views;
+    std::sort(expected.begin(), expected.end());
+
+    sort(views.data(), views.data() + views.size(), std::less<std::string_view>());
+    EXPECT_EQ(views, expected);
+
+    std::vector<std::string_view> small(views.begin(), views.begin() + 10);
+    std::vector<std::string_view> small_expected = small;
+    std::sort(small_expected.begin(), small_expected.end());
+    sort(small.data(), small.data() + small.size(), std::less<>());
+    EXPECT_EQ(small, small_expected);
+}
+
+TEST_F(StringSortTest, LongSharedPrefixes) {
+    // Общий префикс в миллионы слов ключа не должен расходовать стек вызовов
+    const std::size_t prefix = std::size_t(1) << 22;
+    std::vector<std::string> values;
+    for (int i = 0; i < 16; ++i) {
+        values.push_back(std::string(prefix, 'p') + char('a' + (i * 7) % 16));
+    }
+    values.push_back(std::string(prefix, 'p'));
+    values.push_back(values[3]);
+
+    std::vector<std::string> expected = values;
+    std::sort(expected.begin(), expected.end());
+
+    sort(values.data(), values.data() + values.size(), std::less<std::string>());
+    EXPECT_EQ(values, expected);
+}
+
+// Тип с собственными настройками сортировки: порог сортировки вставками
+// больше любого теста, так что quicksort() сводится к сортировке вставками
+struct InsertionOnlyKey {
+    int value;
+};
+
+template <typename Compare>
+struct SortTraits<InsertionOnlyKey, Compare> {
+    static constexpr int insertion_sort_quant = 1 << 20;
+    static constexpr PivotStrategy pivot = PivotStrategy::median_of_three;
+    static constexpr PartitionScheme partition = PartitionScheme::hoare;
+};
+
+class SortTraitsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    template <int Quant, PivotStrategy Pivot, PartitionScheme Partition>
+    struct Traits {
+        static constexpr int insertion_sort_quant = Quant;
+        static constexpr PivotStrategy pivot = Pivot;
+        static constexpr PartitionScheme partition = Partition;
+    };
+
+    struct Record {
+        int key;
+        int payload;
+    };
+
+    template <typename Traits>
+    static void check_tuned(int n) {
+        std::vector<Record> records(n);
+        for (int i = 0; i < n; ++i) {
+            records[i] = {std::rand() % 100, i};
+        }
+        quicksort_tuned<Traits>(records.data(), records.data() + n, [](const Record& a, const Record& b) {
+            return a.key < b.key;
+        });
+        for (int i = 0; i + 1 < n; ++i) {
+            ASSERT_LE(records[i].key, records[i + 1].key);
+        }
+
+        std::vector<std::string> strings(n);
+        for (int i = 0; i < n; ++i) {
+            strings[i] = std::to_string(std::rand() % 1000);
+        }
+        std::vector<std::string> expected = strings;
+        std::sort(expected.begin(), expected.end());
+        quicksort_tuned<Traits>(strings.data(), strings.data() + n, std::less<std::string>());
+        EXPECT_EQ(strings, expected);
+    }
+};
+
+TEST_F(SortTraitsTest, Categories) {
+    EXPECT_EQ((sort_category<int, std::less<int>>), SortCategory::arithmetic);
+    EXPECT_EQ((sort_category<double, std::greater<>>), SortCategory::arithmetic);
+    EXPECT_EQ((sort_category<Record, std::less<Record>>), SortCategory::trivial);
+    EXPECT_EQ((sort_category<int, bool (*)(int, int)>), SortCategory::trivial);
+    EXPECT_EQ((sort_category<std::string, std::less<std::string>>), SortCategory::object);
+
+    struct Large {
+        char bytes[SORT_TUNING_TRIVIAL_MAX_BYTES + 1];
+    };
+    EXPECT_EQ((sort_category<Large, std::less<Large>>), SortCategory::object);
+}
+
+TEST_F(SortTraitsTest, EveryStrategySorts) {
+    for (int n : {0, 1, 5, 100, 1000, 20000}) {
+        check_tuned<Traits<4, PivotStrategy::median_of_three, PartitionScheme::hoare>>(n);
+        check_tuned<Traits<4, PivotStrategy::ninther, PartitionScheme::block>>(n);
+        check_tuned<Traits<32, PivotStrategy::ninther, PartitionScheme::automatic>>(n);
+        check_tuned<Traits<64, PivotStrategy::median_of_three, PartitionScheme::block>>(n);
+    }
+}
+
+TEST_F(SortTraitsTest, SpecializationIsUsed) {
+    const int N = 2000;
+    std::vector<InsertionOnlyKey> keys(N);
+    for (int i = 0; i < N; ++i) {
+        keys[i].value = i + 1;
+    }
+    for (int i = N - 1; i > 0; --i) {
+        std::swap(keys[i].value, keys[std::rand() % (i + 1)].value);
+    }
+
+    long comparisons = 0;
+    quicksort(keys.data(), keys.data() + N, [&comparisons](const InsertionOnlyKey& a, const InsertionOnlyKey& b) {
+        ++comparisons;
+        return a.value < b.value;
+    });
+
+    for (int i = 0; i < N; ++i) {
+        ASSERT_EQ(keys[i].value, i + 1);
+    }
+    // Сортировка вставками случайной перестановки — около n^2 / 4 сравнений,
+    // quicksort() с порогом по умолчанию обошёлся бы примерно 2 n log n
+    EXPECT_GT(comparisons, static_cast<long>(N) * N / 8);
+}
+
+class PivotSelectionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    struct AdaptiveTraits {
+        static constexpr int insertion_sort_quant = 16;
+        static constexpr PivotStrategy pivot = PivotStrategy::adaptive;
+        static constexpr PartitionScheme partition = PartitionScheme::hoare;
+    };
+
+    struct MedianTraits {
+        static constexpr int insertion_sort_quant = 16;
+        static constexpr PivotStrategy pivot = PivotStrategy::median_of_three;
+        static constexpr PartitionScheme partition = PartitionScheme::hoare;
+    };
+
+    static std::vector<int> shuffled(int n) {
+        std::vector<int> values(n);
+        for (int i = 0; i < n; ++i) {
+            values[i] = i;
+        }
+        std::mt19937 gen(std::rand());
+        std::shuffle(values.begin(), values.end(), gen);
+        return values;
+    }
+};
+
+TEST_F(PivotSelectionTest, SampleMedianIsCentral) {
+    const int N = 1 << 20;
+    std::vector<int> values = shuffled(N);
+
+    int* pivot = sample_pivot(values.data(), values.data() + N, std::less<int>());
+
+    // Медиана выборки из 1024 элементов отклоняется от медианы
+    // на несколько процентов
+    EXPECT_GT(*pivot, N / 2 - N / 10);
+    EXPECT_LT(*pivot, N / 2 + N / 10);
+
+    std::vector<int> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    for (int i = 0; i < N; ++i) {
+        ASSERT_EQ(sorted[i], i);
+    }
+}
+
+TEST_F(PivotSelectionTest, SampleOfLargeElements) {
+    struct Wide {
+        long long key;
+        char payload[120];
+    };
+    const int N = 100000;
+    std::vector<Wide> values(N);
+    std::vector<int> keys = shuffled(N);
+    for (int i = 0; i < N; ++i) {
+        values[i].key = keys[i];
+    }
+
+    Wide* pivot = sample_pivot(values.data(), values.data() + N, [](const Wide& a, const Wide& b) {
+        return a.key < b.key;
+    });
+    EXPECT_GT(pivot->key, N / 4);
+    EXPECT_LT(pivot->key, 3 * N / 4);
+}
+
+TEST_F(PivotSelectionTest, AdaptiveSortsLargeInputs) {
+    const int N = 300000;
+    std::vector<std::vector<int>> inputs;
+    inputs.push_back(shuffled(N));
+    std::vector<int> few(N), organ(N), sawtooth(N);
+    for (int i = 0; i < N; ++i) {
+        few[i] = std::rand() % 4;
+        organ[i] = i < N / 2 ? i : N - i;
+        sawtooth[i] = i % 1000;
+    }
+    inputs.push_back(few);
+    inputs.push_back(organ);
+    inputs.push_back(sawtooth);
+
+    for (std::vector<int>& values : inputs) {
+        std::vector<int> expected = values;
+        std::sort(expected.begin(), expected.end());
+        quicksort_tuned<AdaptiveTraits>(values.data(), values.data() + N, std::less<int>());
+        EXPECT_EQ(values, expected);
+    }
+}
+
+TEST_F(PivotSelectionTest, AdaptiveReducesComparisons) {
+    const int N = 1 << 20;
+    std::vector<int> input = shuffled(N);
+
+    long median_comparisons = 0;
+    std::vector<int> values = input;
+    quicksort_tuned<MedianTraits>(values.data(), values.data() + N, [&median_comparisons](int a, int b) {
+        ++median_comparisons;
+        return a < b;
+    });
+
+    long adaptive_comparisons = 0;
+    values = input;
+    quicksort_tuned<AdaptiveTraits>(values.data(), values.data() + N, [&adaptive_comparisons](int a, int b) {
+        ++adaptive_comparisons;
+        return a < b;
+    });
+
+    EXPECT_LT(adaptive_comparisons, median_comparisons);
+}
+
+class SegmentedSortTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    // Смещения сегментов случайной длины из [min_size, max_size]
+    static std::vector<std::size_t> make_offsets(std::size_t segments, int min_size, int max_size) {
+        std::vector<std::size_t> offsets(segments + 1, 0);
+        for (std::size_t i = 0; i < segments; ++i) {
+            offsets[i + 1] = offsets[i] + min_size + std::rand() % (max_size - min_size + 1);
+        }
+        return offsets;
+    }
+
+    template <typename T, typename Compare>
+    static void expect_segments_sorted(const std::vector<T>& original, const std::vector<T>& sorted,
+                                       const std::vector<std::size_t>& offsets, Compare comp) {
+        for (std::size_t i = 0; i + 1 < offsets.size(); ++i) {
+            std::vector<T> expected(original.begin() + offsets[i], original.begin() + offsets[i + 1]);
+            std::sort(expected.begin(), expected.end(), comp);
+            for (std::size_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+                ASSERT_EQ(sorted[j], expected[j - offsets[i]]) << "segment " << i;
+            }
+        }
+    }
+};
+
+TEST_F(SegmentedSortTest, MixedSizes) {
+    std::vector<std::size_t> offsets = make_offsets(5000, 0, 200);
+    std::vector<double> values(offsets.back());
+    for (double& value : values) {
+        value = std::rand() % 1000 - 500;
+    }
+    std::vector<double> sorted = values;
+
+    segmented_sort(sorted.data(), offsets.data(), offsets.size() - 1, std::less<double>());
+    expect_segments_sorted(values, sorted, offsets, std::less<double>());
+
+    sorted = values;
+    segmented_sort(sorted.data(), offsets.data(), offsets.size() - 1, std::greater<double>());
+    expect_segments_sorted(values, sorted, offsets, std::greater<double>());
+}
+
+TEST_F(SegmentedSortTest, TinySegmentsWithoutNetworks) {
+    std::vector<std::size_t> offsets = make_offsets(20000, 1, 20);
+    std::vector<std::string> values(offsets.back());
+    for (std::string& value : values) {
+        value = std::to_string(std::rand() % 100);
+    }
+    std::vector<std::string> sorted = values;
+
+    segmented_sort(sorted.data(), offsets.data(), offsets.size() - 1, std::less<std::string>());
+    expect_segments_sorted(values, sorted, offsets, std::less<std::string>());
+}
+
+TEST_F(SegmentedSortTest, ThreadPoolMatchesSequential) {
+    std::vector<unsigned> offsets32;
+    std::vector<std::size_t> offsets = make_offsets(30000, 5, 40);
+    offsets.push_back(offsets.back() + 100000);
+    for (std::size_t offset : offsets) {
+        offsets32.push_back(static_cast<unsigned>(offset));
+    }
+
+    std::vector<int> values(offsets.back());
+    for (int& value : values) {
+        value = std::rand();
+    }
+    std::vector<int> sequential = values;
+    std::vector<int> parallel = values;
+
+    ThreadPool pool(4);
+    segmented_sort(sequential.data(), offsets32.data(), offsets32.size() - 1, std::less<int>());
+    segmented_sort(parallel.data(), offsets32.data(), offsets32.size() - 1, std::less<int>(), pool);
+
+    EXPECT_EQ(sequential, parallel);
+    expect_segments_sorted(values, parallel, offsets, std::less<int>());
+}
+
+TEST_F(SegmentedSortTest, NoSegments) {
+    std::size_t offsets[] = {0};
+    int value = 0;
+    ThreadPool pool(2);
+    EXPECT_NO_THROW(segmented_sort(&value, offsets, 0, std::less<int>()));
+    EXPECT_NO_THROW(segmented_sort(&value, offsets, 0, std::less<int>(), pool));
+}
+
+class KWayMergeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    // Ключ и номер серии: слияние должно сохранять порядок серий при равных ключах
+    using Item = std::pair<int, int>;
+
+    static bool by_key(const Item& a, const Item& b) {
+        return a.first < b.first;
+    }
+
+    static std::vector<std::vector<Item>> make_runs(int k, int max_size, int max_key) {
+        std::vector<std::vector<Item>> runs(k);
+        for (int r = 0; r < k; ++r) {
+            runs[r].resize(std::rand() % (max_size + 1));
+            for (Item& item : runs[r]) {
+                item = Item(std::rand() % max_key, r);
+            }
+            std::stable_sort(runs[r].begin(), runs[r].end(), by_key);
+        }
+        return runs;
+    }
+
+    static void check_merge(int k, int max_size, int max_key) {
+        std::vector<std::vector<Item>> runs = make_runs(k, max_size, max_key);
+        std::vector<std::pair<const Item*, const Item*>> ranges;
+        std::vector<Item> expected;
+        for (const std::vector<Item>& run : runs) {
+            ranges.emplace_back(run.data(), run.data() + run.size());
+            expected.insert(expected.end(), run.begin(), run.end());
+        }
+        std::stable_sort(expected.begin(), expected.end(), by_key);
+
+        std::vector<Item> merged(expected.size());
+        Item* end = merge_k(ranges, merged.data(), by_key);
+        EXPECT_EQ(end, merged.data() + merged.size()) << "k = " << k;
+        EXPECT_EQ(merged, expected) << "k = " << k;
+    }
+};
+
+TEST_F(KWayMergeTest, MergeTwoIsStable) {
+    std::vector<std::vector<Item>> runs = make_runs(2, 10000, 100);
+    std::vector<Item> expected = runs[0];
+    expected.insert(expected.end(), runs[1].begin(), runs[1].end());
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+
+    std::vector<Item> merged(expected.size());
+    Item* end = merge_two(runs[0].data(), runs[0].data() + runs[0].size(),
+                          runs[1].data(), runs[1].data() + runs[1].size(), merged.data(), by_key);
+    EXPECT_EQ(end, merged.data() + merged.size());
+    EXPECT_EQ(merged, expected);
+}
+
+TEST_F(KWayMergeTest, AnyNumberOfRuns) {
+    const int counts[] = {1, 2, 3, 8, 64, 100};
+    for (int k : counts) {
+        check_merge(k, 2000, 50);
+        check_merge(k, 5, 1000000);
+    }
+
+    std::vector<std::pair<const int*, const int*>> none;
+    int out = 0;
+    EXPECT_EQ(merge_k(none, &out, std::less<int>()), &out);
+}
+
+TEST_F(KWayMergeTest, MovesFromMutableRuns) {
+    std::vector<std::vector<std::string>> runs(5);
+    std::vector<std::string> expected;
+    for (std::vector<std::string>& run : runs) {
+        for (int i = 0; i < 1000; ++i) {
+            run.push_back(std::string(40, 'a') + std::to_string(std::rand() % 10000));
+        }
+        std::sort(run.begin(), run.end());
+        expected.insert(expected.end(), run.begin(), run.end());
+    }
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<std::pair<std::string*, std::string*>> ranges;
+    for (std::vector<std::string>& run : runs) {
+        ranges.emplace_back(run.data(), run.data() + run.size());
+    }
+    std::vector<std::string> merged(expected.size());
+    merge_k(ranges, merged.data(), std::less<std::string>());
+
+    EXPECT_EQ(merged, expected);
+    for (const std::vector<std::string>& run : runs) {
+        for (const std::string& s : run) {
+            ASSERT_TRUE(s.empty()) << "elements of mutable runs must be moved";
+        }
+    }
+}
+
+TEST_F(KWayMergeTest, StreamingSources) {
+    std::vector<std::vector<int>> runs(6);
+    for (std::size_t r = 0; r < runs.size(); ++r) {
+        for (int i = 0; i < 300; ++i) {
+            runs[r].push_back(static_cast<int>(i * runs.size() + r));
+        }
+    }
+
+    std::vector<RunSource<const int>> sources;
+    for (const std::vector<int>& run : runs) {
+        sources.emplace_back(run.data(), run.data() + run.size());
+    }
+
+    // Приёмник проверяет порядок, не накапливая результат
+    int expected = 0;
+    merge_sources<int>(sources, [&expected](const int& value) {
+        EXPECT_EQ(value, expected);
+        ++expected;
+    }, std::less<int>());
+    EXPECT_EQ(expected, 6 * 300);
+}
+
+class SortReduceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    struct Group {
+        int key;
+        long long sum;
+        int count;
+    };
+
+    static bool by_key(const Group& a, const Group& b) {
+        return a.key < b.key;
+    }
+
+    template <typename T, typename Compare>
+    static void check_unique(std::vector<T> data, Compare comp) {
+        std::vector<T> expected = data;
+        std::sort(expected.begin(), expected.end(), comp);
+        expected.erase(std::unique(expected.begin(), expected.end(),
+                                   [comp](const T& a, const T& b) { return !comp(a, b) && !comp(b, a); }),
+                       expected.end());
+
+        T* end = sort_unique(data.data(), data.data() + data.size(), comp);
+        ASSERT_EQ(static_cast<std::size_t>(end - data.data()), expected.size());
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), data.data()));
+    }
+};
+
+TEST_F(SortReduceTest, UniqueAnyCardinality) {
+    const int N = 100000;
+    const int cardinalities[] = {1, 2, 10, 1000, N, INT_MAX};
+    for (int cardinality : cardinalities) {
+        std::vector<int> data(N);
+        for (int& value : data) {
+            value = std::rand() % cardinality;
+        }
+        check_unique(data, std::less<int>());
+        check_unique(data, std::greater<int>());
+
+        std::sort(data.begin(), data.end());
+        check_unique(data, std::less<int>());
+        check_unique(data, std::greater<int>());
+    }
+
+    check_unique(std::vector<int>(), std::less<int>());
+    check_unique(std::vector<int>{5}, std::less<int>());
+}
+
+TEST_F(SortReduceTest, UniqueStringsAndLargeRecords) {
+    std::vector<std::string> strings(20000);
+    for (std::string& s : strings) {
+        s = "prefix_" + std::to_string(std::rand() % 3000);
+    }
+    check_unique(strings, std::less<std::string>());
+
+    std::vector<std::string_view> views(strings.begin(), strings.end());
+    check_unique(views, std::less<std::string_view>());
+
+    std::vector<std::array<int, 200>> records(3000);
+    for (std::array<int, 200>& record : records) {
+        record.fill(std::rand() % 100);
+    }
+    check_unique(records, std::less<std::array<int, 200>>());
+}
+
+TEST_F(SortReduceTest, ReduceSumsGroups) {
+    const int cardinalities[] = {3, 500, 50000};
+    for (int cardinality : cardinalities) {
+        const int N = 100000;
+        std::vector<Group> data(N);
+        std::map<int, std::pair<long long, int>> expected;
+        for (Group& group : data) {
+            group = Group{std::rand() % cardinality, std::rand() % 1000, 1};
+            expected[group.key].first += group.sum;
+            expected[group.key].second += 1;
+        }
+
+        Group* end = sort_reduce(data.data(), data.data() + N, by_key, [](Group& acc, Group&& x) {
+            acc.sum += x.sum;
+            acc.count += x.count;
+        });
+
+        ASSERT_EQ(static_cast<std::size_t>(end - data.data()), expected.size());
+        auto it = expected.begin();
+        for (Group* g = data.data(); g != end; ++g, ++it) {
+            ASSERT_EQ(g->key, it->first);
+            EXPECT_EQ(g->sum, it->second.first);
+            EXPECT_EQ(g->count, it->second.second);
+        }
+    }
+}
+
+class SortedIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    // Индекс над sorted отвечает так же, как std::lower_bound, поштучно и пачкой
+    template <typename T, typename Compare>
+    static void check_index(const std::vector<T>& sorted, const std::vector<T>& queries, Compare comp) {
+        SortedIndex<T, Compare> index(sorted.data(), sorted.data() + sorted.size(), comp);
+        ASSERT_EQ(index.size(), sorted.size());
+
+        std::vector<std::size_t> batch(queries.size());
+        index.lower_bound(queries.data(), queries.size(), batch.data());
+
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            std::size_t expected = std::lower_bound(sorted.begin(), sorted.end(), queries[i], comp) - sorted.begin();
+            ASSERT_EQ(index.lower_bound(queries[i]), expected) << "n = " << sorted.size();
+            ASSERT_EQ(batch[i], expected) << "n = " << sorted.size();
+            EXPECT_EQ(index.contains(queries[i]), std::binary_search(sorted.begin(), sorted.end(), queries[i], comp));
+        }
+        for (std::size_t i = 0; i < sorted.size(); ++i) {
+            ASSERT_EQ(index[i], sorted[i]);
+        }
+    }
+
+    template <typename T, typename Compare>
+    static void check_sizes(Compare comp) {
+        const std::size_t sizes[] = {0, 1, 2, 7, 8, 15, 16, 17, 100, 16 * 17, 16 * 17 + 1, 5000, 100000};
+        for (std::size_t n : sizes) {
+            int range = static_cast<int>(n) * 2 + 4;
+            std::vector<T> sorted(n);
+            for (T& value : sorted) {
+                value = static_cast<T>(std::rand() % range);
+            }
+            std::sort(sorted.begin(), sorted.end(), comp);
+
+            std::vector<T> queries(2000);
+            for (T& query : queries) {
+                query = static_cast<T>(std::rand() % (range + 4) - 2);
+            }
+            check_index(sorted, queries, comp);
+        }
+    }
+};
+
+TEST_F(SortedIndexTest, MatchesLowerBound) {
+    check_sizes<int>(std::less<int>());
+    check_sizes<long long>(std::greater<long long>());
+    check_sizes<double>(std::less<double>());
+    check_sizes<float>(std::greater<float>());
+    check_sizes<short>(std::less<short>());
+}
+
+TEST_F(SortedIndexTest, CustomCompareAndLargeKeys) {
+    auto by_abs = [](int a, int b) { return std::abs(a) < std::abs(b); };
+    check_sizes<int>(by_abs);
+
+    std::vector<std::string> sorted(3000);
+    for (std::string& s : sorted) {
+        s = "key" + std::to_string(std::rand() % 1000);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<std::string> queries(1000);
+    for (std::string& q : queries) {
+        q = "key" + std::to_string(std::rand() % 1100);
+    }
+    queries.push_back("");
+    queries.push_back("zzz");
+    check_index(sorted, queries, std::less<std::string>());
+}
+
+TEST_F(SortedIndexTest, DuplicatesAndUnsortedInput) {
+    std::vector<int> same(1000, 7);
+    check_index(same, std::vector<int>{6, 7, 8}, std::less<int>());
+
+    std::vector<int> unsorted = {1, 3, 2};
+    EXPECT_THROW((SortedIndex<int>(unsorted.data(), unsorted.data() + unsorted.size())), std::invalid_argument);
+}
+
+class SetOpsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    // Упорядоченное по comp множество из не более чем n значений [0, range)
+    template <typename T, typename Compare>
+    static std::vector<T> make_set(std::size_t n, int range, Compare comp) {
+        std::vector<T> values(n);
+        for (T& value : values) {
+            value = static_cast<T>(std::rand() % range);
+        }
+        std::sort(values.begin(), values.end(), comp);
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        return values;
+    }
+
+    // Выходные буферы ровно той ёмкости, которую требует контракт
+    template <typename T, typename Compare>
+    static void check_pair(const std::vector<T>& a, const std::vector<T>& b, Compare comp) {
+        std::vector<T> expected;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected), comp);
+        std::vector<T> result(std::min(a.size(), b.size()));
+        T* end = intersect_sorted(a.data(), a.data() + a.size(), b.data(), b.data() + b.size(), result.data(), comp);
+        result.resize(end - result.data());
+        ASSERT_EQ(result, expected) << a.size() << " x " << b.size();
+
+        expected.clear();
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected), comp);
+        result.assign(a.size() + b.size(), T());
+        end = union_sorted(a.data(), a.data() + a.size(), b.data(), b.data() + b.size(), result.data(), comp);
+        result.resize(end - result.data());
+        ASSERT_EQ(result, expected) << a.size() << " x " << b.size();
+    }
+
+    template <typename T, typename Compare>
+    static void check_sizes(Compare comp) {
+        const std::size_t sizes[][2] = {{0, 0}, {0, 10}, {7, 5}, {100, 100}, {1000, 997}, {5000, 3000},
+                                        {20000, 100}, {50, 30000}, {100000, 1}, {30000, 30000}};
+        const int densities[] = {2, 8, 100};
+        for (const auto& size : sizes) {
+            for (int density : densities) {
+                int range = static_cast<int>(std::max(size[0], size[1])) * density + 1;
+                check_pair(make_set<T>(size[0], range, comp), make_set<T>(size[1], range, comp), comp);
+            }
+        }
+    }
+};
+
+TEST_F(SetOpsTest, GallopLowerBound) {
+    std::vector<int> values = make_set<int>(5000, 20000, std::less<int>());
+    for (int query = -1; query <= 20001; query += 7) {
+        for (std::size_t start : {std::size_t(0), values.size() / 3}) {
+            auto expected = std::lower_bound(values.begin() + start, values.end(), query);
+            const int* found = gallop_lower_bound(values.data() + start, values.data() + values.size(), query,
+                                                  std::less<int>());
+            ASSERT_EQ(found - values.data(), expected - values.begin()) << "query " << query;
+        }
+    }
+}
+
+TEST_F(SetOpsTest, IntersectionAndUnionAllTypes) {
+    check_sizes<int>(std::less<int>());
+    check_sizes<unsigned>(std::greater<unsigned>());
+    check_sizes<long long>(std::less<long long>());
+    check_sizes<std::uint64_t>(std::less<std::uint64_t>());
+    check_sizes<double>(std::greater<double>());
+    check_sizes<short>(std::less<short>());
+}
+
+TEST_F(SetOpsTest, LargeUnsignedIds) {
+    std::vector<std::uint64_t> a, b;
+    for (std::uint64_t i = 0; i < 5000; ++i) {
+        a.push_back((i << 40) | 0xFFFFFFFFull);
+        if (i % 3 == 0) {
+            b.push_back((i << 40) | 0xFFFFFFFFull);
+        } else {
+            b.push_back(i << 40);
+        }
+    }
+    check_pair(a, b, std::less<std::uint64_t>());
+}
+
+TEST_F(SetOpsTest, MergeJoinProducesAllPairs) {
+    struct Order {
+        int customer;
+        int id;
+    };
+    struct Customer {
+        int id;
+        int region;
+    };
+    struct ByCustomer {
+        bool operator()(const Order& o, const Customer& c) const { return o.customer < c.id; }
+        bool operator()(const Customer& c, const Order& o) const { return c.id < o.customer; }
+    };
+
+    const std::size_t sizes[][2] = {{1000, 300}, {30000, 200}, {50, 5000}, {0, 10}};
+    for (const auto& size : sizes) {
+        std::vector<Order> orders(size[0]);
+        for (std::size_t i = 0; i < orders.size(); ++i) {
+            orders[i] = Order{std::rand() % 500, static_cast<int>(i)};
+        }
+        sort(orders.data(), orders.data() + orders.size(),
+             [](const Order& a, const Order& b) { return a.customer < b.customer; });
+
+        // Повторяющиеся ключи справа тоже дают все пары
+        std::vector<Customer> customers(size[1]);
+        for (std::size_t i = 0; i < customers.size(); ++i) {
+            customers[i] = Customer{std::rand() % 700, static_cast<int>(i)};
+        }
+        sort(customers.data(), customers.data() + customers.size(),
+             [](const Customer& a, const Customer& b) { return a.id < b.id; });
+
+        std::vector<std::pair<int, int>> expected;
+        for (const Order& o : orders) {
+            for (const Customer& c : customers) {
+                if (o.customer == c.id) {
+                    expected.emplace_back(o.id, c.region);
+                }
+            }
+        }
+
+        std::vector<std::pair<int, int>> joined;
+        std::size_t pairs = merge_join(orders.data(), orders.data() + orders.size(), customers.data(),
+                                       customers.data() + customers.size(), ByCustomer(),
+                                       [&joined](const Order& o, const Customer& c) {
+                                           joined.emplace_back(o.id, c.region);
+                                       });
+
+        EXPECT_EQ(pairs, joined.size());
+        std::sort(expected.begin(), expected.end());
+        std::sort(joined.begin(), joined.end());
+        EXPECT_EQ(joined, expected);
+    }
+}
+
+class AsyncSortTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    static std::vector<int> random_vector(std::size_t n) {
+        std::vector<int> data(n);
+        for (int& value : data) {
+            value = std::rand();
+        }
+        return data;
+    }
+
+    static bool same_elements(std::vector<int> a, std::vector<int> b) {
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        return a == b;
+    }
+};
+
+TEST_F(AsyncSortTest, CompletesWithFullProgress) {
+    ThreadPool pool(4);
+    const std::size_t sizes[] = {0, 1, 1000, 1000000};
+    for (std::size_t n : sizes) {
+        std::vector<int> data = random_vector(n);
+        std::vector<int> expected = data;
+        std::sort(expected.begin(), expected.end());
+
+        SortHandle handle = sort_async(data.data(), data.data() + n, std::less<int>(), pool);
+        EXPECT_EQ(handle.get(), SortStatus::completed);
+        EXPECT_TRUE(handle.ready());
+        EXPECT_EQ(handle.progress(), n);
+        EXPECT_EQ(handle.size(), n);
+        EXPECT_EQ(data, expected);
+    }
+}
+
+TEST_F(AsyncSortTest, CallerIsNotBlockedAndCancelStopsAtPartition) {
+    ThreadPool pool(2);
+    std::vector<int> data = random_vector(1 << 20);
+    std::vector<int> original = data;
+
+    // Первое сравнение ждёт, пока тест не убедится, что sort_async()
+    // вернула управление, и не отменит сортировку
+    std::atomic<bool> gate{false};
+    auto comp = [&gate](int a, int b) {
+        while (!gate.load()) {
+            std::this_thread::yield();
+        }
+        return a < b;
+    };
+
+    SortHandle handle = sort_async(data.data(), data.data() + data.size(), comp, pool);
+    EXPECT_FALSE(handle.ready());
+    EXPECT_FALSE(handle.wait_for(std::chrono::milliseconds(10)));
+
+    handle.cancel();
+    gate = true;
+    EXPECT_EQ(handle.get(), SortStatus::cancelled);
+    EXPECT_LT(handle.progress(), data.size());
+    EXPECT_TRUE(same_elements(data, original));
+}
+
+TEST_F(AsyncSortTest, DeadlineStopsCleanly) {
+    ThreadPool pool(2);
+    std::vector<int> data = random_vector(1 << 20);
+    std::vector<int> original = data;
+
+    SortHandle handle = sort_async(data.data(), data.data() + data.size(), std::less<int>(), pool,
+                                   std::chrono::steady_clock::now() - std::chrono::seconds(1));
+    EXPECT_EQ(handle.wait(), SortStatus::deadline_expired);
+    EXPECT_EQ(handle.progress(), 0u);
+    EXPECT_EQ(data, original);
+
+    SortHandle relaxed = sort_async(data.data(), data.data() + data.size(), std::less<int>(), pool,
+                                    std::chrono::steady_clock::now() + std::chrono::hours(1));
+    EXPECT_EQ(relaxed.wait(), SortStatus::completed);
+    EXPECT_TRUE(std::is_sorted(data.begin(), data.end()));
+}
+
+TEST_F(AsyncSortTest, ExceptionIsReportedByGet) {
+    ThreadPool pool(3);
+    std::vector<int> data = random_vector(1 << 19);
+    std::vector<int> original = data;
+
+    std::atomic<int> calls{0};
+    auto comp = [&calls](int a, int b) {
+        if (++calls == 2000000) {
+            throw std::runtime_error("comparison failed");
+        }
+        return a < b;
+    };
+
+    SortHandle handle = sort_async(data.data(), data.data() + data.size(), comp, pool);
+    EXPECT_THROW(handle.get(), std::runtime_error);
+    EXPECT_EQ(handle.status(), SortStatus::failed);
+}
+
+TEST_F(AsyncSortTest, DestroyedHandleCancelsAndWaits) {
+    ThreadPool pool(2);
+    std::vector<int> data = random_vector(1 << 20);
+    std::vector<int> original = data;
+    {
+        SortHandle handle = sort_async(data.data(), data.data() + data.size(), std::less<int>(), pool);
+    }
+    // Задачи сортировки уже не работают с data
+    EXPECT_TRUE(same_elements(data, original));
+}
+
+TEST_F(AsyncSortTest, PoolDestroyedBeforeHandle) {
+    std::vector<int> data = random_vector(1 << 20);
+    std::vector<int> expected = data;
+    std::sort(expected.begin(), expected.end());
+
+    auto local = std::make_unique<ThreadPool>(2);
+    SortHandle handle = sort_async(data.data(), data.data() + data.size(), std::less<int>(), *local);
+    // Пул доделывает поставленные задачи, поэтому дескриптор не зависает
+    local.reset();
+    EXPECT_EQ(handle.wait(), SortStatus::completed);
+    EXPECT_EQ(data, expected);
+}
+
+class SortStatsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::srand(std::time(nullptr));
+    }
+
+    struct Item {
+        int key;
+        int id;
+    };
+
+    static std::uint64_t balance_total(const SortStats& stats) {
+        std::uint64_t total = 0;
+        for (std::uint64_t count : stats.balance) {
+            total += count;
+        }
+        return total;
+    }
+};
+
+TEST_F(SortStatsTest, CountsComparatorCallsExactly) {
+    const int N = 100000;
+    std::vector<Item> items(N);
+    for (int i = 0; i < N; ++i) {
+        items[i] = Item{std::rand() % 1000, i};
+    }
+    std::vector<Item> plain = items;
+
+    std::uint64_t calls = 0;
+    auto by_key = [&calls](const Item& a, const Item& b) {
+        ++calls;
+        return a.key < b.key;
+    };
+
+    SortStats stats = quicksort_with_stats(items.data(), items.data() + N, by_key);
+    EXPECT_EQ(stats.comparisons, calls);
+
+    // Тот же путь сортировки: неустойчивый порядок равных ключей совпадает
+    quicksort(plain.data(), plain.data() + N, by_key);
+    for (int i = 0; i < N; ++i) {
+        ASSERT_EQ(items[i].id, plain[i].id) << "index " << i;
+    }
+
+    EXPECT_GT(stats.partitions, 0u);
+    EXPECT_GT(stats.three_way_partitions, 0u);
+    EXPECT_EQ(balance_total(stats), stats.partitions);
+    EXPECT_GT(stats.insertion_sorts, 0u);
+    EXPECT_GT(stats.swaps, 0u);
+    EXPECT_GT(stats.moves, 0u);
+    EXPECT_EQ(stats.heap_sort_fallbacks, 0u);
+    EXPECT_GT(stats.max_depth, 0);
+    EXPECT_LE(stats.max_depth, 2 * floor_log2(N));
+}
+
+TEST_F(SortStatsTest, RandomInputIsBalanced) {
+    const int N = 1 << 18;
+    // Различные значения: повтор опорного элемента законно включил бы
+    // трёхпутевое разбиение
+    std::vector<double> data(N);
+    for (int i = 0; i < N; ++i) {
+        data[i] = i;
+    }
+    std::mt19937 gen(std::rand());
+    std::shuffle(data.begin(), data.end(), gen);
+
+    SortStats stats = quicksort_with_stats(data.data(), data.data() + N, std::greater<double>());
+    EXPECT_TRUE(std::is_sorted(data.begin(), data.end(), std::greater<double>()));
+
+    // Почти все разбиения случайного входа отделяют не меньше 1/16 диапазона
+    EXPECT_LT(stats.balance[0] * 20, stats.partitions);
+    EXPECT_EQ(stats.three_way_partitions, 0u);
+}
+
+TEST_F(SortStatsTest, PresortedInputsSkipPartitioning) {
+    const int N = 10000;
+    std::vector<int> ascending(N);
+    for (int i = 0; i < N; ++i) {
+        ascending[i] = i;
+    }
+    std::vector<int> descending(ascending.rbegin(), ascending.rend());
+
+    SortStats sorted = quicksort_with_stats(ascending.data(), ascending.data() + N, std::less<int>());
+    EXPECT_EQ(sorted.partitions, 0u);
+    EXPECT_EQ(sorted.swaps, 0u);
+    EXPECT_EQ(sorted.comparisons, static_cast<std::uint64_t>(N));
+
+    SortStats reversed = quicksort_with_stats(descending.data(), descending.data() + N, std::less<int>());
+    EXPECT_EQ(descending, ascending);
+    EXPECT_EQ(reversed.partitions, 0u);
+    EXPECT_EQ(reversed.swaps, static_cast<std::uint64_t>(N / 2));
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();